@@ -0,0 +1,174 @@
+#pragma once
+#include <cstdint>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bit-sliced building blocks shared by the packed engines. A word (or a SIMD
+// vector of LANES words) holds one bit per cell and the neighbour counts are
+// formed with bitwise full adders, 64 cells per word at a time. vec wraps the
+// widest instruction set the build targets (AVX-512, AVX2, else one plain word)
+// behind the same small set of operations.
+
+namespace bit_packed {
+    inline int popcount64(uint64_t x) {
+#ifdef _MSC_VER
+        return (int)__popcnt64(x);
+#else
+        return __builtin_popcountll(x);
+#endif
+    }
+
+    inline uint64_t andnot(uint64_t a, uint64_t b) { return a & ~b; }
+    inline uint64_t complement(uint64_t a) { return ~a; }
+
+#if defined(__AVX512F__)
+    struct vec {
+        __m512i v;
+        static vec load(const uint64_t* p) { return { _mm512_loadu_si512(p) }; }
+        void store(uint64_t* p) const { _mm512_storeu_si512(p, v); }
+        static vec splat(uint64_t x) { return { _mm512_set1_epi64((long long)x) }; }
+        vec shl1() const { return { _mm512_slli_epi64(v, 1) }; }
+        vec shr1() const { return { _mm512_srli_epi64(v, 1) }; }
+        vec shl63() const { return { _mm512_slli_epi64(v, 63) }; }
+        vec shr63() const { return { _mm512_srli_epi64(v, 63) }; }
+        vec shl(int n) const { return { _mm512_sll_epi64(v, _mm_cvtsi32_si128(n)) }; }
+        vec shr(int n) const { return { _mm512_srl_epi64(v, _mm_cvtsi32_si128(n)) }; }
+    };
+    inline vec operator&(vec a, vec b) { return { _mm512_and_si512(a.v, b.v) }; }
+    inline vec operator|(vec a, vec b) { return { _mm512_or_si512(a.v, b.v) }; }
+    inline vec operator^(vec a, vec b) { return { _mm512_xor_si512(a.v, b.v) }; }
+    inline vec andnot(vec a, vec b) { return { _mm512_andnot_si512(b.v, a.v) }; }
+    inline vec complement(vec a) { return { _mm512_xor_si512(a.v, _mm512_set1_epi64(-1)) }; }
+    constexpr int LANES = 8;
+    constexpr const char* SIMD_PATH = "avx512";
+#elif defined(__AVX2__)
+    struct vec {
+        __m256i v;
+        static vec load(const uint64_t* p) { return { _mm256_loadu_si256((const __m256i*)p) }; }
+        void store(uint64_t* p) const { _mm256_storeu_si256((__m256i*)p, v); }
+        static vec splat(uint64_t x) { return { _mm256_set1_epi64x((long long)x) }; }
+        vec shl1() const { return { _mm256_slli_epi64(v, 1) }; }
+        vec shr1() const { return { _mm256_srli_epi64(v, 1) }; }
+        vec shl63() const { return { _mm256_slli_epi64(v, 63) }; }
+        vec shr63() const { return { _mm256_srli_epi64(v, 63) }; }
+        vec shl(int n) const { return { _mm256_sll_epi64(v, _mm_cvtsi32_si128(n)) }; }
+        vec shr(int n) const { return { _mm256_srl_epi64(v, _mm_cvtsi32_si128(n)) }; }
+    };
+    inline vec operator&(vec a, vec b) { return { _mm256_and_si256(a.v, b.v) }; }
+    inline vec operator|(vec a, vec b) { return { _mm256_or_si256(a.v, b.v) }; }
+    inline vec operator^(vec a, vec b) { return { _mm256_xor_si256(a.v, b.v) }; }
+    inline vec andnot(vec a, vec b) { return { _mm256_andnot_si256(b.v, a.v) }; }
+    inline vec complement(vec a) { return { _mm256_xor_si256(a.v, _mm256_set1_epi64x(-1)) }; }
+    constexpr int LANES = 4;
+    constexpr const char* SIMD_PATH = "avx2";
+#else
+    struct vec {
+        uint64_t v;
+        static vec load(const uint64_t* p) { return { *p }; }
+        void store(uint64_t* p) const { *p = v; }
+        static vec splat(uint64_t x) { return { x }; }
+        vec shl1() const { return { v << 1 }; }
+        vec shr1() const { return { v >> 1 }; }
+        vec shl63() const { return { v << 63 }; }
+        vec shr63() const { return { v >> 63 }; }
+        vec shl(int n) const { return { v << n }; }
+        vec shr(int n) const { return { v >> n }; }
+    };
+    inline vec operator&(vec a, vec b) { return { a.v & b.v }; }
+    inline vec operator|(vec a, vec b) { return { a.v | b.v }; }
+    inline vec operator^(vec a, vec b) { return { a.v ^ b.v }; }
+    inline vec andnot(vec a, vec b) { return { a.v & ~b.v }; }
+    inline vec complement(vec a) { return { ~a.v }; }
+    constexpr int LANES = 1;
+    constexpr const char* SIMD_PATH = "scalar";
+#endif
+
+    // Bit-sliced B3/S23: each row of three contributes a 2-bit count, the three
+    // counts are summed with full adders. A cell lives next generation when the
+    // "twos" column holds exactly one (count 2 or 3) and either the "ones" bit is
+    // set (count 3) or the cell is already alive (count 2).
+    template <typename V>
+    inline V life_rule(V uw, V u, V ue, V mw, V m, V me, V dw, V d, V de) {
+        V t0 = uw ^ u ^ ue;
+        V t1 = (uw & u) | (ue & (uw ^ u));
+        V b0 = dw ^ d ^ de;
+        V b1 = (dw & d) | (de & (dw ^ d));
+        V m0 = mw ^ me;
+        V m1 = mw & me;
+        V s0 = t0 ^ m0 ^ b0;
+        V c0 = (t0 & m0) | (b0 & (t0 ^ m0));
+        V p1 = t1 ^ m1;
+        V q1 = t1 & m1;
+        V p2 = b1 ^ c0;
+        V q2 = b1 & c0;
+        V exactly_one_two = andnot(p1 ^ p2, q1 | q2);
+        return exactly_one_two & (s0 | m);
+    }
+
+    struct ConwayRule {
+        template <typename V>
+        V operator()(V uw, V u, V ue, V mw, V m, V me, V dw, V d, V de) const {
+            return life_rule(uw, u, ue, mw, m, me, dw, d, de);
+        }
+    };
+
+    template <uint16_t Birth, uint16_t Survive>
+    struct StaticMasks {
+        static constexpr uint16_t birth = Birth;
+        static constexpr uint16_t survive = Survive;
+    };
+
+    struct RuntimeMasks {
+        uint16_t birth;
+        uint16_t survive;
+    };
+
+    // Any two-state B/S rule. The same adders as above sum the eight neighbours
+    // into four bit slices; the rule is then an OR of one "count == n" test per
+    // n in its birth or survive set. With StaticMasks the loop over n folds
+    // away and only the tests the rule needs are emitted.
+    template <typename Masks>
+    struct SlicedRule {
+        Masks masks;
+
+        template <typename V>
+        V operator()(V uw, V u, V ue, V mw, V m, V me, V dw, V d, V de) const {
+            V t0 = uw ^ u ^ ue;
+            V t1 = (uw & u) | (ue & (uw ^ u));
+            V b0 = dw ^ d ^ de;
+            V b1 = (dw & d) | (de & (dw ^ d));
+            V m0 = mw ^ me;
+            V m1 = mw & me;
+            V s0 = t0 ^ m0 ^ b0;
+            V c0 = (t0 & m0) | (b0 & (t0 ^ m0));
+            V x = t1 ^ m1;
+            V xc = t1 & m1;
+            V y = b1 ^ c0;
+            V yc = b1 & c0;
+            V s1 = x ^ y;
+            V c1 = x & y;
+            V s2 = xc ^ yc ^ c1;
+            V s3 = (xc & yc) | (c1 & (xc ^ yc));
+            const V slices[4] = { s0, s1, s2, s3 };
+
+            V born = m ^ m;
+            V kept = m ^ m;
+            for (int n = 0; n <= 8; n++) {
+                bool births = (masks.birth >> n) & 1;
+                bool survives = (masks.survive >> n) & 1;
+                if (!births && !survives)
+                    continue;
+                V equal = (n & 1) ? slices[0] : complement(slices[0]);
+                for (int bit = 1; bit < 4; bit++)
+                    equal = equal & (((n >> bit) & 1) ? slices[bit] : complement(slices[bit]));
+                if (births)
+                    born = born | equal;
+                if (survives)
+                    kept = kept | equal;
+            }
+            return andnot(born, m) | (kept & m);
+        }
+    };
+}
\ No newline at end of file
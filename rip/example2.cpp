@@ -1,47 +1,34 @@
 // game_of_life.cpp
-// Compile: g++ -std=c++17 -O2 -pthread -o game_of_life game_of_life.cpp
+// Compile: g++ -std=c++17 -O2 -pthread -o game_of_life example2.cpp life_async_render.cpp
 // Run examples:
 //   ./game_of_life            (default 40x80 random, 100 gens, wrap mode)
 //   ./game_of_life 30 120 200 100 wrap 0.25
 //   ./game_of_life 20 60 0 200 finite 0.12   (0 gens => run until Ctrl-C)
+//   ./game_of_life 40 80 0 0 wrap 0.25 1000   (stop on any period up to 1000)
 
+#include "game_of_life.h"
 #include <bits/stdc++.h>
-#include <thread>
-#include <chrono>
 using namespace std;
 
 using Grid = vector<vector<uint8_t>>; // 0 or 1
 
 // Print usage
 void print_usage(const char* prog) {
-    cout << "Usage: " << prog << " [rows cols generations delay_ms mode seed_prob]\n"
+    cout << "Usage: " << prog << " [rows cols generations delay_ms mode seed_prob max_period]\n"
         << "  rows, cols        : grid size (default 40 80)\n"
         << "  generations       : number of generations to run (0 = infinite) (default 100)\n"
-        << "  delay_ms          : milliseconds between frames (default 100)\n"
+        << "  delay_ms          : minimum milliseconds between drawn frames; the simulation\n"
+        << "                      does not wait, frames in between are skipped (default 100)\n"
         << "  mode              : 'wrap' (toroidal) or 'finite' (default wrap)\n"
-        << "  seed_prob         : probability 0..1 to start a live cell (default 0.25)\n         << "Example: " << prog << " 30 120 200 100 wrap 0.2\n";
+        << "  seed_prob         : probability 0..1 to start a live cell (default 0.25)\n"
+        << "  max_period        : longest oscillator period to detect (default 64)\n"
+        << "Example: " << prog << " 30 120 200 100 wrap 0.2\n";
 }
 
-// Clear terminal (ANSI)
-void clear_screen() {
-    // Cursor to top-left and clear screen
-    cout << "\x1b[H\x1b[2J";
-}
-
-// Print grid to terminal
-void print_grid(const Grid& g) {
-    size_t r = g.size();
-    size_t c = g.empty() ? 0 : g[0].size();
-    for (size_t i = 0; i < r; ++i) {
-        for (size_t j = 0; j < c; ++j) {
-            cout << (g[i][j] ? 'O' : ' ');
-        }
-        cout << '\n';
-    }
-}
-
-// Count neighbors for cell (i,j) with chosen mode
-int count_neighbors(const Grid& g, int i, int j, bool wrap) {
+// Count neighbors for cell (i,j) with chosen mode. The mode is a template
+// argument so the wrap test is resolved at compile time, not per neighbor.
+template <bool Wrap>
+int count_neighbors(const Grid& g, int i, int j) {
     int r = (int)g.size();
     int c = (int)g[0].size();
     int cnt = 0;
@@ -50,7 +37,7 @@ int count_neighbors(const Grid& g, int i, int j, bool wrap) {
             if (di == 0 && dj == 0) continue;
             int ni = i + di;
             int nj = j + dj;
-            if (wrap) {
+            if constexpr (Wrap) {
                 // toroidal wrap
                 if (ni < 0) ni += r;
                 if (ni >= r) ni -= r;
@@ -67,14 +54,37 @@ int count_neighbors(const Grid& g, int i, int j, bool wrap) {
     return cnt;
 }
 
-// Compute next generation
-Grid next_generation(const Grid& curr, bool wrap) {
+// Zobrist hashing: every cell gets a random 64-bit key and the grid hash is the
+// XOR of the keys of all live cells, so flipping a cell is a single XOR.
+struct ZobristKeys {
+    int cols;
+    vector<uint64_t> keys;
+
+    ZobristKeys(int rows, int cols, uint64_t seed) : cols(cols), keys((size_t)rows * cols) {
+        mt19937_64 rng(seed);
+        for (auto& key : keys) key = rng();
+    }
+    uint64_t key(int i, int j) const { return keys[(size_t)i * cols + j]; }
+};
+
+uint64_t grid_hash(const Grid& g, const ZobristKeys& zobrist) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < g.size(); ++i)
+        for (size_t j = 0; j < g[i].size(); ++j)
+            if (g[i][j]) hash ^= zobrist.key((int)i, (int)j);
+    return hash;
+}
+
+// Compute next generation into next, updating hash for every cell that flips.
+// Returns the number of flipped cells.
+template <bool Wrap>
+int next_generation(const Grid& curr, Grid& next, const ZobristKeys& zobrist, uint64_t& hash) {
     int r = (int)curr.size();
     int c = (int)curr[0].size();
-    Grid next(r, vector<uint8_t>(c, 0));
+    int flips = 0;
     for (int i = 0; i < r; ++i) {
         for (int j = 0; j < c; ++j) {
-            int n = count_neighbors(curr, i, j, wrap);
+            int n = count_neighbors<Wrap>(curr, i, j);
             if (curr[i][j]) {
                 // alive
                 next[i][j] = (n == 2 || n == 3) ? 1 : 0;
@@ -83,9 +93,13 @@ Grid next_generation(const Grid& curr, bool wrap) {
                 // dead
                 next[i][j] = (n == 3) ? 1 : 0;
             }
+            if (next[i][j] != curr[i][j]) {
+                hash ^= zobrist.key(i, j);
+                ++flips;
+            }
         }
     }
-    return next;
+    return flips;
 }
 
 // Compare grids
@@ -93,6 +107,35 @@ bool same_grid(const Grid& a, const Grid& b) {
     return a == b;
 }
 
+// Remembers the hashes of the last max_period generations. observe() returns the
+// distance to the most recent generation with the same hash (a candidate period),
+// or 0. A hit still has to be confirmed, hashes can collide.
+class CycleHistory {
+public:
+    explicit CycleHistory(int max_period) : max_period(max_period), ring(max_period, 0) {}
+
+    int observe(uint64_t hash, int gen) {
+        int period = 0;
+        auto it = last_seen.find(hash);
+        if (it != last_seen.end() && gen - it->second <= max_period)
+            period = gen - it->second;
+        if (gen >= max_period) {
+            uint64_t oldest = ring[gen % max_period];
+            auto old = last_seen.find(oldest);
+            if (old != last_seen.end() && old->second == gen - max_period)
+                last_seen.erase(old);
+        }
+        ring[gen % max_period] = hash;
+        last_seen[hash] = gen;
+        return period;
+    }
+
+private:
+    int max_period;
+    vector<uint64_t> ring;
+    unordered_map<uint64_t, int> last_seen;
+};
+
 // Random seed
 Grid random_grid(int rows, int cols, double prob, std::mt19937& rng) {
     Grid g(rows, vector<uint8_t>(cols, 0));
@@ -113,6 +156,7 @@ int main(int argc, char** argv) {
     int delay_ms = 100;
     string mode = "wrap";
     double seed_prob = 0.25;
+    int max_period = 64;
 
     if (argc >= 2) {
         if (string(argv[1]) == "-h" || string(argv[1]) == "--help") {
@@ -125,11 +169,16 @@ int main(int argc, char** argv) {
     if (argc >= 5) delay_ms = stoi(argv[4]);
     if (argc >= 6) mode = argv[5];
     if (argc >= 7) seed_prob = stod(argv[6]);
+    if (argc >= 8) max_period = stoi(argv[7]);
 
     if (rows <= 0 || cols <= 0) {
         cerr << "rows and cols must be positive\n";
         return 1;
     }
+    if (max_period <= 0) {
+        cerr << "max_period must be positive\n";
+        return 1;
+    }
     bool wrap = (mode == "wrap" || mode == "toroid" || mode == "toroidal");
 
     // RNG
@@ -165,35 +214,63 @@ int main(int argc, char** argv) {
         }
     }
 
-    Grid prev;
+    ZobristKeys zobrist(rows, cols, rng());
+    uint64_t hash = grid_hash(grid, zobrist);
+    CycleHistory history(max_period);
+    Grid next(rows, vector<uint8_t>(cols, 0));
+
+    // A hash hit at distance p only nominates a period: the grid is kept and
+    // compared in full once, p generations later.
+    Grid candidate;
+    uint64_t candidate_hash = 0;
+    int candidate_gen = 0;
+    int candidate_period = 0;
+
     int gen = 0;
     bool infinite = (generations == 0);
+    string outcome;
 
-    while (infinite || gen < generations) {
-        clear_screen();
-        cout << "Conway's Game of Life  Generation: " << gen << "  (" << rows << "x" << cols << ")  Mode: " << (wrap ? "wrap" : "finite") << "\n";
-        print_grid(grid);
-
-        Grid next = next_generation(grid, wrap);
+    {
+        // Drawing and frame pacing run on the renderer's thread; the loop only
+        // copies the grid when the renderer is waiting for one. Leaving this
+        // scope draws the last frame, so the outcome is printed below it.
+        async_render::TerminalRenderer renderer(rows, cols, 2, delay_ms);
+        while (infinite || gen < generations) {
+            if (renderer.wants_frame())
+                renderer.submit(grid, gen);
 
-        if (same_grid(next, grid)) {
-            cout << "\nStable (no changes)  stopping at generation " << gen << ".\n";
-            break;
-        }
-        if (!prev.empty() && same_grid(next, prev)) {
-            cout << "\nEntered 2-step oscillator (period 2)  stopping at generation " << gen << ".\n";
-            break;
-        }
+            if (candidate_period && gen == candidate_gen + candidate_period) {
+                if (hash == candidate_hash && same_grid(grid, candidate)) {
+                    outcome = "Entered oscillator (period " + to_string(candidate_period) + ")  stopping at generation " + to_string(gen) + ".";
+                    break;
+                }
+                candidate_period = 0;
+            }
+            int period = history.observe(hash, gen);
+            if (period && !candidate_period) {
+                candidate = grid;
+                candidate_hash = hash;
+                candidate_gen = gen;
+                candidate_period = period;
+            }
 
-        prev = grid;
-        grid = move(next);
+            int flips = wrap ? next_generation<true>(grid, next, zobrist, hash)
+                             : next_generation<false>(grid, next, zobrist, hash);
+            if (flips == 0) {
+                outcome = "Stable (no changes)  stopping at generation " + to_string(gen) + ".";
+                break;
+            }
 
-        ++gen;
-        if (!infinite && gen >= generations) break;
+            swap(grid, next);
 
-        this_thread::sleep_for(chrono::milliseconds(delay_ms));
+            ++gen;
+        }
+        renderer.submit(grid, gen);
     }
 
+    cout << "Conway's Game of Life  (" << rows << "x" << cols << ")  Mode: " << (wrap ? "wrap" : "finite") << "\n";
+    if (!outcome.empty())
+        cout << outcome << "\n";
     cout << "Finished at generation " << gen << ".\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,519 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Declarations shared by the Game of Life engines. Every engine imports from and
+// exports to the same row-major 0/1 matrix that multi_core (rip.cpp) works on.
+
+namespace bit_packed {
+    // 64 cells per word, bit b of word w holds column w * 64 + b. One extra zero
+    // row is kept after the last row so the finite mode can read "outside" rows
+    // without branching or allocating.
+    struct BitGrid {
+        int rows = 0;
+        int cols = 0;
+        int words_per_row = 0;
+        std::vector<uint64_t> words;
+
+        BitGrid() = default;
+        BitGrid(int rows, int cols);
+
+        uint64_t* row(int i) { return words.data() + (size_t)i * words_per_row; }
+        const uint64_t* row(int i) const { return words.data() + (size_t)i * words_per_row; }
+        const uint64_t* zero_row() const { return row(rows); }
+        uint64_t last_word_mask() const;
+
+        int get(int i, int j) const;
+        void set(int i, int j, int value);
+    };
+
+    BitGrid from_matrix(const std::vector<std::vector<int>>& matrix);
+    std::vector<std::vector<int>> to_matrix(const BitGrid& grid);
+
+    // B3/S23. next must have the same shape as current.
+    void calculate_next_generation(const BitGrid& current, BitGrid& next, bool wrap);
+    // Any two-state rule, given as birth/survive neighbour-count masks (bit n set
+    // = n neighbours). Built-in life_rules rules run a kernel compiled for them.
+    void calculate_next_generation(const BitGrid& current, BitGrid& next, bool wrap, uint16_t birth,
+        uint16_t survive);
+    // One packed row of cols cells from the rows above and below it. For the
+    // finite mode pass a zero row for neighbours outside the board.
+    void calculate_next_row(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+        int cols, bool wrap);
+    long long population(const BitGrid& grid);
+    const char* simd_path();
+}
+
+namespace halo_grid {
+    // next state indexed by [cell][live_neighbours], B3/S23
+    inline constexpr uint8_t CONWAY_RULE[2][9] = {
+        { 0, 0, 0, 1, 0, 0, 0, 0, 0 },
+        { 0, 0, 1, 1, 0, 0, 0, 0, 0 },
+    };
+
+    // Contiguous grid with a one-cell ghost border. Interior cell (i, j) lives at
+    // cells[(i + 1) * stride + j + 1]; the boundary mode only decides what the
+    // border holds, so the update loop never checks bounds.
+    struct HaloGrid {
+        int rows = 0;
+        int cols = 0;
+        int stride = 0;
+        std::vector<uint8_t> cells;
+
+        HaloGrid() = default;
+        HaloGrid(int rows, int cols);
+
+        uint8_t* row(int i) { return cells.data() + (size_t)(i + 1) * stride + 1; }
+        const uint8_t* row(int i) const { return cells.data() + (size_t)(i + 1) * stride + 1; }
+        uint8_t& at(int i, int j) { return row(i)[j]; }
+        uint8_t at(int i, int j) const { return row(i)[j]; }
+
+        void fill_halo(bool wrap);
+    };
+
+    // Two preallocated generations that swap roles every step.
+    class DoubleBuffer {
+    public:
+        DoubleBuffer(int rows, int cols);
+
+        HaloGrid& current() { return buffers[front]; }
+        const HaloGrid& current() const { return buffers[front]; }
+        void step(bool wrap);
+
+    private:
+        HaloGrid buffers[2];
+        int front = 0;
+    };
+
+    void load_matrix(HaloGrid& grid, const std::vector<std::vector<int>>& matrix);
+    std::vector<std::vector<int>> to_matrix(const HaloGrid& grid);
+    void calculate_next_generation(HaloGrid& current, HaloGrid& next, bool wrap);
+}
+
+namespace hash_life {
+    // Canonicalised quadtree over the unbounded plane. A node of level k covers a
+    // 2^k x 2^k square; identical squares share one node, and every node caches
+    // its centre half advanced by the current step, so repeated structure in
+    // space and time is only ever computed once. max_nodes bounds the live
+    // nodes during a jump too: a jump that would exceed it is redone as
+    // shorter jumps with a collection in between, so a cap far below what a
+    // long jump needs costs time instead of memory. Running out of 32-bit
+    // node indices, or a single generation needing more than max_nodes,
+    // throws std::runtime_error.
+    class Universe {
+    public:
+        explicit Universe(size_t max_nodes = (size_t)1 << 24);
+
+        // Places matrix[i][j] at column x0 + j, row y0 + i, replacing the universe.
+        void load_matrix(const std::vector<std::vector<int>>& matrix, int64_t x0 = 0, int64_t y0 = 0);
+        std::vector<std::vector<int>> to_matrix(int64_t x0, int64_t y0, int rows, int cols) const;
+        int get(int64_t x, int64_t y) const;
+
+        // Splits generations into power-of-two jumps.
+        void advance(uint64_t generations);
+        void advance_pow2(int log2_generations);
+
+        uint64_t generation() const { return generation_count; }
+        uint64_t population() const;
+        size_t node_count() const { return nodes.size() - free_nodes.size(); }
+        void collect_garbage();
+
+    private:
+        struct Node {
+            uint32_t nw, ne, sw, se;
+            uint32_t next;   // hash chain
+            uint32_t result; // centre advanced by 2^step_log2, or NONE
+            uint64_t population;
+            int level;
+            bool marked;
+        };
+
+        uint32_t leaf(int alive) const { return alive ? 1 : 0; }
+        uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+        uint32_t empty(int level);
+        uint32_t centre(uint32_t n);
+        uint32_t step_base(uint32_t n);
+        uint32_t next(uint32_t n);
+        uint32_t build(const std::vector<std::vector<int>>& matrix, int level, int64_t x, int64_t y);
+        void export_node(uint32_t n, int64_t x, int64_t y, int64_t x0, int64_t y0,
+            std::vector<std::vector<int>>& matrix) const;
+        bool fits_centre() const;
+        void expand();
+        void set_step(int log2_generations);
+        void rehash(size_t bucket_count);
+        void mark(uint32_t n);
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> free_nodes;
+        std::vector<uint32_t> buckets;
+        std::vector<uint32_t> empty_nodes;
+        size_t max_nodes;
+        uint32_t root = 0;
+        int64_t origin_x = 0;
+        int64_t origin_y = 0;
+        int step_log2 = -1;
+        bool jumping = false;
+        uint64_t generation_count = 0;
+    };
+
+    // Generation `generations` of matrix on the unbounded plane, cropped back to
+    // the original window. Stands in for stepping one generation at a time.
+    std::vector<std::vector<int>> calculate_generation(const std::vector<std::vector<int>>& matrix,
+        uint64_t generations);
+}
+
+namespace dirty_tiles {
+    // Splits the board into tile_size x tile_size tiles and only recomputes tiles
+    // that changed, or touch a tile that changed, in the previous generation.
+    // Tiles that are skipped already hold the right cells in the back buffer,
+    // because they did not change between the last two generations.
+    class TiledLife {
+    public:
+        TiledLife(int rows, int cols, int tile_size = 64);
+
+        void load_matrix(const std::vector<std::vector<int>>& matrix);
+        std::vector<std::vector<int>> to_matrix() const;
+        const halo_grid::HaloGrid& current() const { return buffers[front]; }
+        void step(bool wrap);
+
+        int tile_count() const { return tiles_x * tiles_y; }
+        int active_tile_count() const { return (int)active.size(); }
+        // Bytes held by both generations and the per-tile bookkeeping.
+        size_t footprint_bytes() const;
+
+    private:
+        void collect_active_tiles(bool wrap);
+        bool calculate_tile(int tile);
+
+        halo_grid::HaloGrid buffers[2];
+        int front = 0;
+        int tile_size;
+        int tiles_x;
+        int tiles_y;
+        std::vector<uint8_t> changed;
+        std::vector<uint8_t> next_changed;
+        std::vector<int> active;
+    };
+}
+
+namespace temporal_blocking {
+    struct Parameters {
+        int tile_size;
+        int generations_per_block;
+    };
+
+    // Picks a tile and a block depth k so that a tile plus its k-wide ghost zone,
+    // double buffered, fits in cache_bytes (0 = detected per-core L2 size).
+    Parameters auto_parameters(size_t cache_bytes = 0);
+
+    // Overlapped ghost zones: every tile copies itself plus a k-cell ghost zone
+    // into a per-thread scratch area, advances k generations there while the
+    // valid region shrinks by one cell per generation, and writes back only the
+    // tile. The board is read and written once per k generations.
+    class BlockedLife {
+    public:
+        BlockedLife(int rows, int cols, Parameters parameters = auto_parameters());
+
+        void load_matrix(const std::vector<std::vector<int>>& matrix);
+        std::vector<std::vector<int>> to_matrix() const;
+        const halo_grid::HaloGrid& current() const { return buffers[front]; }
+        const Parameters& parameters() const { return params; }
+        void advance(int generations, bool wrap);
+        // Bytes held by both generations and every thread's scratch area.
+        size_t footprint_bytes() const;
+
+    private:
+        void advance_block(int generations, bool wrap);
+        void advance_tile(int tile, int generations, bool wrap, std::vector<uint8_t>& scratch);
+
+        halo_grid::HaloGrid buffers[2];
+        int front = 0;
+        Parameters params;
+        int tiles_x;
+        int tiles_y;
+        std::vector<std::vector<uint8_t>> scratch;
+    };
+}
+
+namespace async_render {
+    // Draws generations on its own thread. submit() copies a snapshot into one
+    // of a fixed set of frame slots and returns immediately; when the renderer
+    // falls behind, the oldest pending frame is overwritten (dropped). Each
+    // frame is diffed against what is on screen, built in one buffer as ANSI
+    // cursor moves plus the changed cells, and written with a single write call.
+    // Only one thread may call submit(). There are queue_capacity slots plus
+    // the one being drawn, and a submit() holds its slot outside the queue
+    // while copying, so a second concurrent submit() can find neither a free
+    // nor a pending slot to take. Several stepping threads must submit from
+    // one of them or serialise the calls.
+    class TerminalRenderer {
+    public:
+        TerminalRenderer(int rows, int cols, int queue_capacity = 2, int frame_interval_ms = 16);
+        ~TerminalRenderer();
+        TerminalRenderer(const TerminalRenderer&) = delete;
+        TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+        void submit(const halo_grid::HaloGrid& grid, long long generation);
+        void submit(const std::vector<std::vector<int>>& matrix, long long generation);
+        // rows of 0/1 bytes, copied a row at a time
+        void submit(const std::vector<std::vector<uint8_t>>& matrix, long long generation);
+        // True while the render thread is idle with nothing queued. A loop that
+        // only submits then copies one grid per drawn frame instead of one per
+        // generation; the last generation should be submitted regardless.
+        bool wants_frame() const { return waiting.load(std::memory_order_relaxed); }
+
+        long long frames_drawn() const;
+        long long frames_dropped() const;
+
+    private:
+        struct Frame {
+            std::vector<uint8_t> cells;
+            long long generation = 0;
+        };
+
+        int acquire_slot();
+        void publish(int slot);
+        void run();
+        void draw(const Frame& frame);
+
+        int rows;
+        int cols;
+        int frame_interval_ms;
+        std::vector<Frame> frames;
+        std::vector<int> free_slots;
+        std::deque<int> pending;
+        std::mutex mutex;
+        std::condition_variable ready;
+        bool stopping = false;
+        std::atomic<long long> drawn{ 0 };
+        std::atomic<long long> dropped{ 0 };
+        std::atomic<bool> waiting{ false };
+
+        // owned by the render thread
+        std::vector<uint8_t> shown;
+        bool has_shown = false;
+        std::string out;
+        std::thread worker;
+    };
+}
+
+namespace many_core_life {
+    // OpenCL backend. Both generations live in device buffers that swap roles
+    // every step; step() only enqueues work on an in-order queue and the host
+    // synchronises only in snapshot(). Prefers a GPU and falls back to a CPU
+    // device (e.g. PoCL). OpenCL failures throw std::runtime_error.
+    class OpenCLLife {
+    public:
+        OpenCLLife(int rows, int cols, bool wrap);
+        ~OpenCLLife();
+        OpenCLLife(const OpenCLLife&) = delete;
+        OpenCLLife& operator=(const OpenCLLife&) = delete;
+
+        void load_matrix(const std::vector<std::vector<int>>& matrix);
+        void step(int generations = 1);
+        std::vector<std::vector<int>> snapshot();
+        const std::string& device_name() const { return device; }
+
+    private:
+        void fit_local_size();
+        void release();
+
+        struct Handles;
+        Handles* cl;
+        int rows;
+        int cols;
+        bool wrap;
+        int front = 0;
+        std::string device;
+    };
+}
+
+namespace streaming_life {
+    // Grid file used by the streaming mode: the 8-byte magic "LIFEBITS", rows and
+    // cols as little-endian uint64, then every row as (cols + 63) / 64 packed
+    // words in the bit_packed layout.
+    bool write_grid_file(const char* path, const bit_packed::BitGrid& grid);
+    bool read_grid_file(const char* path, bit_packed::BitGrid& grid);
+
+    // Advances the grid in in_path by `generations` and writes it to out_path
+    // without ever holding more than a few rows per stage in memory. Each pass
+    // over the file runs up to `stages` generations as a pipeline of threads
+    // (reader, one thread per generation, writer) joined by bounded row queues.
+    // Returns false when a file cannot be read or written.
+    bool stream_generations(const char* in_path, const char* out_path, int generations, bool wrap, int stages = 4);
+}
+
+namespace pattern_io {
+    // Pattern loaders. Files are memory mapped and split into chunks that are
+    // parsed by all OpenMP threads. The grid is the pattern's bounding box (RLE:
+    // the x/y of its header). Only the cells are read; rule lines are ignored.
+    // Return false when the file cannot be read or is malformed.
+    bool load_rle(const char* path, bit_packed::BitGrid& grid);
+    bool load_life106(const char* path, bit_packed::BitGrid& grid);
+    bool load_macrocell(const char* path, bit_packed::BitGrid& grid);
+    // Picks the format from the first line ("[M2]", "#Life 1.06", otherwise RLE).
+    bool load_pattern(const char* path, bit_packed::BitGrid& grid);
+}
+
+namespace checkpoint {
+    // Snapshot file: a header (magic "LIFECKPT", version, rows, cols, generation),
+    // a directory with the offset, size and encoding of every tile of tile_rows
+    // packed rows, then the tiles. With compress set, a tile is stored zero-run
+    // coded whenever that is smaller. Tiles are encoded, written and read back in
+    // parallel. The file is written beside path and renamed into place, so an
+    // interrupted checkpoint never replaces a good one.
+    bool write_checkpoint(const char* path, const bit_packed::BitGrid& grid, uint64_t generation,
+        bool compress = true, int tile_rows = 256);
+    bool read_checkpoint(const char* path, bit_packed::BitGrid& grid, uint64_t& generation);
+}
+
+namespace batch_life {
+    // Many small independent boards, e.g. for soup searches: every board is a
+    // random soup in the middle of an otherwise empty rows x cols board and is
+    // run until it repeats a state (period 1 .. max_period) or max_generations.
+    struct Config {
+        int rows = 32;
+        int cols = 32;         // at most 64, one word per row
+        int soup_rows = 16;
+        int soup_cols = 16;
+        double density = 0.5;  // rounded to a multiple of 1/256
+        bool wrap = true;
+        int max_generations = 4096;
+        int max_period = 6;
+        uint64_t seed = 1;
+    };
+
+    struct Result {
+        uint64_t board = 0;
+        int generations = 0;   // first generation of the final cycle
+        int period = 0;        // 0 when max_generations ran out first
+        int population = 0;    // at the end of the run
+    };
+
+    struct Stats {
+        uint64_t boards = 0;
+        double seconds = 0;
+        double boards_per_second = 0;
+    };
+
+    // Receives results in blocks, one call at a time, in no particular order.
+    using Sink = std::function<void(const std::vector<Result>& results)>;
+
+    // The soup of a board depends only on config.seed and the board number.
+    // rows receives config.rows words.
+    void seed_board(const Config& config, uint64_t board, uint64_t* rows);
+
+    // Runs boards first_board .. first_board + board_count - 1. Each thread
+    // (0 = all OpenMP threads) steps bit_packed::LANES boards at once in SIMD
+    // lanes, refills a lane as soon as its board settles, and pulls board
+    // numbers from a work-stealing queue.
+    Stats run_batch(const Config& config, uint64_t first_board, uint64_t board_count, const Sink& sink,
+        int threads = 0);
+}
+
+namespace numa_life {
+    // CPUs of every NUMA node, from /sys/devices/system/node or the Windows NUMA
+    // API. A machine without NUMA information is one node with all CPUs.
+    struct Topology {
+        std::vector<std::vector<int>> node_cpus;
+    };
+    Topology detect_topology();
+
+    // Bit-packed Life split into one row band per thread. Threads are pinned to
+    // cores, consecutive bands on the same node, and every band is allocated
+    // and first-touched by its own thread, so its pages stay on that node. The
+    // partition is fixed at construction. Per generation a thread copies the
+    // edge rows of the two neighbouring bands into its local halo rows; those
+    // rows are the only data that crosses nodes. Every call needs a full team
+    // of one OpenMP thread per band and throws std::runtime_error otherwise
+    // (e.g. called from a parallel region with nesting off).
+    class NumaLife {
+    public:
+        NumaLife(int rows, int cols, int threads = 0);
+
+        void load_matrix(const std::vector<std::vector<int>>& matrix);
+        std::vector<std::vector<int>> to_matrix() const;
+        void advance(int generations, bool wrap);
+        void step(bool wrap) { advance(1, wrap); }
+
+        int thread_count() const { return (int)bands.size(); }
+        int node_of_thread(int thread) const { return bands[thread].node; }
+        int cpu_of_thread(int thread) const { return bands[thread].cpu; }
+
+    private:
+        struct Band {
+            int first_row = 0;
+            int rows = 0;
+            int node = 0;
+            int cpu = 0;
+            std::vector<uint64_t> cells[2]; // rows + 2 packed rows, halo first and last
+        };
+
+        uint64_t* band_row(Band& band, int buffer, int i);
+        const uint64_t* band_row(const Band& band, int buffer, int i) const;
+
+        int rows;
+        int cols;
+        int words_per_row;
+        int front = 0;
+        Topology topology;
+        std::vector<Band> bands;
+    };
+}
+
+namespace pipelined_life {
+    // Conway on a halo grid stepped by a pool of threads that lives as long as
+    // the object. Each thread owns a row band and publishes the number of
+    // generations it has finished in an atomic counter; a band starts its next
+    // generation as soon as the bands above and below have caught up, so there
+    // is no barrier across all threads and a fast band may run one generation
+    // ahead of its neighbours.
+    class PipelinedLife {
+    public:
+        PipelinedLife(int rows, int cols, int threads = 0);
+        ~PipelinedLife();
+        PipelinedLife(const PipelinedLife&) = delete;
+        PipelinedLife& operator=(const PipelinedLife&) = delete;
+
+        void load_matrix(const std::vector<std::vector<int>>& matrix);
+        std::vector<std::vector<int>> to_matrix() const;
+        void advance(int generations, bool wrap);
+        void step(bool wrap) { advance(1, wrap); }
+
+        int thread_count() const { return (int)bands.size(); }
+        long long generation() const { return generation_count; }
+
+    private:
+        struct alignas(64) Band {
+            int first_row = 0;
+            int rows = 0;
+            std::atomic<long long> done{ 0 };
+        };
+
+        void run(int t);
+        void wait_for(int t, long long generation) const;
+        void advance_band(int t, long long goal, bool wrap);
+
+        halo_grid::HaloGrid buffers[2];
+        std::vector<Band> bands;
+        long long generation_count = 0;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        long long run_id = 0;
+        long long target = 0;
+        bool wrap_mode = false;
+        int running = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "game_of_life.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace async_render {
+    const char* const ALIVE = "\033[07m  \033[m";
+    const char* const DEAD = "  ";
+
+    static void write_stdout(const std::string& data) {
+        size_t written = 0;
+        while (written < data.size()) {
+#ifdef _WIN32
+            int n = _write(1, data.data() + written, (unsigned int)(data.size() - written));
+#else
+            long n = (long)::write(1, data.data() + written, data.size() - written);
+#endif
+            if (n <= 0)
+                return;
+            written += (size_t)n;
+        }
+    }
+
+    TerminalRenderer::TerminalRenderer(int rows, int cols, int queue_capacity, int frame_interval_ms)
+        : rows(rows), cols(cols), frame_interval_ms(frame_interval_ms),
+          frames(std::max(queue_capacity, 1) + 1), shown((size_t)rows * cols, 0) {
+        // one slot more than the queue holds, for the frame being drawn
+        for (int slot = 0; slot < (int)frames.size(); slot++) {
+            frames[slot].cells.resize((size_t)rows * cols);
+            free_slots.push_back(slot);
+        }
+        out.reserve((size_t)rows * cols * 16);
+        worker = std::thread(&TerminalRenderer::run, this);
+    }
+
+    TerminalRenderer::~TerminalRenderer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_one();
+        worker.join();
+    }
+
+    long long TerminalRenderer::frames_drawn() const {
+        return drawn.load();
+    }
+
+    long long TerminalRenderer::frames_dropped() const {
+        return dropped.load();
+    }
+
+    int TerminalRenderer::acquire_slot() {
+        waiting.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_slots.empty()) {
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        int slot = pending.front();
+        pending.pop_front();
+        dropped++;
+        return slot;
+    }
+
+    void TerminalRenderer::publish(int slot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(slot);
+        }
+        ready.notify_one();
+    }
+
+    void TerminalRenderer::submit(const halo_grid::HaloGrid& grid, long long generation) {
+        int slot = acquire_slot();
+        Frame& frame = frames[slot];
+        for (int i = 0; i < rows; i++)
+            std::memcpy(frame.cells.data() + (size_t)i * cols, grid.row(i), cols);
+        frame.generation = generation;
+        publish(slot);
+    }
+
+    void TerminalRenderer::submit(const std::vector<std::vector<int>>& matrix, long long generation) {
+        int slot = acquire_slot();
+        Frame& frame = frames[slot];
+        for (int i = 0; i < rows; i++) {
+            uint8_t* cells = frame.cells.data() + (size_t)i * cols;
+            for (int j = 0; j < cols; j++)
+                cells[j] = matrix[i][j] ? 1 : 0;
+        }
+        frame.generation = generation;
+        publish(slot);
+    }
+
+    void TerminalRenderer::submit(const std::vector<std::vector<uint8_t>>& matrix, long long generation) {
+        int slot = acquire_slot();
+        Frame& frame = frames[slot];
+        for (int i = 0; i < rows; i++)
+            std::memcpy(frame.cells.data() + (size_t)i * cols, matrix[i].data(), cols);
+        frame.generation = generation;
+        publish(slot);
+    }
+
+    static void move_cursor(std::string& out, int row, int col) {
+        char escape[32];
+        int length = std::snprintf(escape, sizeof(escape), "\x1b[%d;%dH", row, col);
+        out.append(escape, length);
+    }
+
+    void TerminalRenderer::draw(const Frame& frame) {
+        out.clear();
+        if (!has_shown)
+            out += "\x1b[H\x1b[2J";
+        move_cursor(out, 1, 1);
+        out += "Generation: " + std::to_string(frame.generation) + "\x1b[K";
+        for (int i = 0; i < rows; i++) {
+            const uint8_t* cells = frame.cells.data() + (size_t)i * cols;
+            uint8_t* on_screen = shown.data() + (size_t)i * cols;
+            int j = 0;
+            while (j < cols) {
+                if (has_shown && cells[j] == on_screen[j]) {
+                    j++;
+                    continue;
+                }
+                move_cursor(out, i + 2, 2 * j + 1);
+                while (j < cols && (!has_shown || cells[j] != on_screen[j])) {
+                    out += cells[j] ? ALIVE : DEAD;
+                    on_screen[j] = cells[j];
+                    j++;
+                }
+            }
+        }
+        move_cursor(out, rows + 2, 1);
+        has_shown = true;
+        write_stdout(out);
+        drawn++;
+    }
+
+    void TerminalRenderer::run() {
+        for (;;) {
+            int slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                waiting.store(pending.empty(), std::memory_order_relaxed);
+                ready.wait(lock, [this] { return stopping || !pending.empty(); });
+                waiting.store(false, std::memory_order_relaxed);
+                if (pending.empty())
+                    return;
+                // only the newest snapshot is worth drawing
+                while (pending.size() > 1) {
+                    free_slots.push_back(pending.front());
+                    pending.pop_front();
+                    dropped++;
+                }
+                slot = pending.front();
+                pending.pop_front();
+            }
+            draw(frames[slot]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                free_slots.push_back(slot);
+            }
+            if (frame_interval_ms > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(frame_interval_ms));
+        }
+    }
+
+    //int main()
+    //{
+    //    halo_grid::DoubleBuffer generations(multi_core::M, multi_core::N);
+    //    halo_grid::load_matrix(generations.current(), multi_core::generate_start_values());
+    //    TerminalRenderer renderer(multi_core::M, multi_core::N);
+    //    for (int iteration = 0; iteration < multi_core::NUMBER_OF_ITERATIONS; iteration++) {
+    //        if (renderer.wants_frame() || iteration == multi_core::NUMBER_OF_ITERATIONS - 1)
+    //            renderer.submit(generations.current(), iteration);
+    //        generations.step(false);
+    //    }
+    //    return 0;
+    //}
+}
\ No newline at end of file
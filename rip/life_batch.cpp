@@ -0,0 +1,295 @@
+#include "game_of_life.h"
+#include "bit_sliced.h"
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace batch_life {
+    const size_t SINK_BATCH = 4096;
+
+    static inline uint64_t mix64(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Counter-based: the value depends only on (key, counter), so any thread
+    // can produce any board's soup without sharing generator state, and a board
+    // is the same whichever worker or lane happens to run it.
+    static inline uint64_t counter_random(uint64_t key, uint64_t counter) {
+        return mix64(key ^ mix64(counter + 0x9e3779b97f4a7c15ULL));
+    }
+
+    // A word whose bits are set with probability threshold / 256: folding in one
+    // fresh word per bit of the threshold, lowest first, with | for a one and &
+    // for a zero halves or doubles the density at every step.
+    static uint64_t random_row(uint64_t key, uint64_t row, int threshold) {
+        if (threshold <= 0)
+            return 0;
+        if (threshold >= 256)
+            return ~0ULL;
+        int bit = 0;
+        while (!((threshold >> bit) & 1))
+            bit++;
+        uint64_t word = 0;
+        for (; bit < 8; bit++) {
+            uint64_t draw = counter_random(key, row * 8 + bit);
+            word = (threshold >> bit) & 1 ? word | draw : word & draw;
+        }
+        return word;
+    }
+
+    void seed_board(const Config& config, uint64_t board, uint64_t* rows) {
+        int soup_rows = std::min(config.soup_rows, config.rows);
+        int soup_cols = std::min(config.soup_cols, config.cols);
+        int top = (config.rows - soup_rows) / 2;
+        int left = (config.cols - soup_cols) / 2;
+        int threshold = (int)(config.density * 256 + 0.5);
+        uint64_t soup_mask = soup_cols >= 64 ? ~0ULL : (1ULL << soup_cols) - 1;
+        uint64_t key = mix64(config.seed ^ mix64(board));
+        std::memset(rows, 0, (size_t)config.rows * sizeof(uint64_t));
+        for (int r = 0; r < soup_rows; r++)
+            rows[top + r] = (random_row(key, (uint64_t)r, threshold) & soup_mask) << left;
+    }
+
+    // Board indices still to run. Every worker owns a contiguous range and takes
+    // from its front; a worker that runs dry steals the back half of another
+    // worker's range, so boards that settle early never leave a core idle.
+    class StealingQueue {
+    public:
+        StealingQueue(uint64_t first, uint64_t count, int workers) : ranges(workers) {
+            for (int w = 0; w < workers; w++) {
+                ranges[w].begin = first + count * w / workers;
+                ranges[w].end = first + count * (w + 1) / workers;
+            }
+        }
+
+        bool pop(int worker, uint64_t& board) {
+            {
+                Range& own = ranges[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.begin < own.end) {
+                    board = own.begin++;
+                    return true;
+                }
+            }
+            int workers = (int)ranges.size();
+            for (int offset = 1; offset < workers; offset++) {
+                Range& victim = ranges[(worker + offset) % workers];
+                uint64_t begin, end;
+                {
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (victim.begin >= victim.end)
+                        continue;
+                    uint64_t half = (victim.end - victim.begin + 1) / 2;
+                    end = victim.end;
+                    begin = end - half;
+                    victim.end = begin;
+                }
+                Range& own = ranges[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin + 1;
+                own.end = end;
+                board = begin;
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        struct alignas(64) Range {
+            std::mutex mutex;
+            uint64_t begin = 0;
+            uint64_t end = 0;
+        };
+        std::vector<Range> ranges;
+    };
+
+    // LANES boards side by side: row r of lane l is cells[r * LANES + l], so one
+    // vector holds the same row of every board and a generation of the whole
+    // group costs as much as a generation of one board. Boards are at most 64
+    // columns wide, one word per row. The last max_period + 1 generations stay
+    // in a ring, which doubles as the front and back buffer and as the history
+    // a settled board is confirmed against.
+    class LaneGroup {
+    public:
+        LaneGroup(const Config& config)
+            : config(config), period_limit(std::max(config.max_period, 1)), slots(period_limit + 1),
+              col_mask(config.cols >= 64 ? ~0ULL : (1ULL << config.cols) - 1),
+              history((size_t)slots * config.rows * bit_packed::LANES, 0),
+              hashes((size_t)slots * bit_packed::LANES, 0),
+              board(bit_packed::LANES, 0), age(bit_packed::LANES, -1), seed(config.rows) {
+        }
+
+        bool active(int lane) const { return age[lane] >= 0; }
+
+        void load(int lane, uint64_t index) {
+            seed_board(config, index, seed.data());
+            uint64_t* cells = slot(step_count);
+            for (int r = 0; r < config.rows; r++)
+                cells[(size_t)r * bit_packed::LANES + lane] = seed[r];
+            hashes[(size_t)(step_count % slots) * bit_packed::LANES + lane] = hash(cells, lane);
+            board[lane] = index;
+            age[lane] = 0;
+        }
+
+        // Advances every lane and reports the lanes that settled or ran out of
+        // generations; those lanes are free for the next board afterwards.
+        void step(std::vector<Result>& finished) {
+            const uint64_t* current = slot(step_count);
+            uint64_t* next = slot(step_count + 1);
+            int rows = config.rows;
+            int cols = config.cols;
+            bit_packed::vec mask = bit_packed::vec::splat(col_mask);
+            bit_packed::vec low = bit_packed::vec::splat(1);
+            bit_packed::vec zero = bit_packed::vec::splat(0);
+            for (int r = 0; r < rows; r++) {
+                int above = r > 0 ? r - 1 : (config.wrap ? rows - 1 : -1);
+                int below = r + 1 < rows ? r + 1 : (config.wrap ? 0 : -1);
+                bit_packed::vec u = above >= 0 ? bit_packed::vec::load(current + (size_t)above * bit_packed::LANES) : zero;
+                bit_packed::vec m = bit_packed::vec::load(current + (size_t)r * bit_packed::LANES);
+                bit_packed::vec d = below >= 0 ? bit_packed::vec::load(current + (size_t)below * bit_packed::LANES) : zero;
+                bit_packed::vec uw = u.shl1(), ue = u.shr1();
+                bit_packed::vec mw = m.shl1(), me = m.shr1();
+                bit_packed::vec dw = d.shl1(), de = d.shr1();
+                if (config.wrap) {
+                    uw = uw | u.shr(cols - 1);
+                    mw = mw | m.shr(cols - 1);
+                    dw = dw | d.shr(cols - 1);
+                    ue = ue | (u & low).shl(cols - 1);
+                    me = me | (m & low).shl(cols - 1);
+                    de = de | (d & low).shl(cols - 1);
+                }
+                (bit_packed::life_rule(uw, u, ue, mw, m, me, dw, d, de) & mask)
+                    .store(next + (size_t)r * bit_packed::LANES);
+            }
+            step_count++;
+
+            for (int lane = 0; lane < bit_packed::LANES; lane++) {
+                if (!active(lane))
+                    continue;
+                age[lane]++;
+                uint64_t h = hash(next, lane);
+                hashes[(size_t)(step_count % slots) * bit_packed::LANES + lane] = h;
+                int period = 0;
+                for (int p = 1; p <= std::min(period_limit, age[lane]) && period == 0; p++) {
+                    uint64_t back = step_count - p;
+                    if (hashes[(size_t)(back % slots) * bit_packed::LANES + lane] == h && same(slot(back), next, lane))
+                        period = p;
+                }
+                if (period == 0 && age[lane] < config.max_generations)
+                    continue;
+                Result result;
+                result.board = board[lane];
+                result.period = period;
+                result.generations = age[lane] - period;
+                result.population = population(next, lane);
+                finished.push_back(result);
+                age[lane] = -1;
+            }
+        }
+
+    private:
+        uint64_t* slot(uint64_t step) { return history.data() + (size_t)(step % slots) * config.rows * bit_packed::LANES; }
+
+        uint64_t hash(const uint64_t* cells, int lane) const {
+            uint64_t h = 0;
+            for (int r = 0; r < config.rows; r++)
+                h = (h ^ cells[(size_t)r * bit_packed::LANES + lane]) * 0x9e3779b97f4a7c15ULL + (uint64_t)r;
+            return h;
+        }
+
+        bool same(const uint64_t* a, const uint64_t* b, int lane) const {
+            for (int r = 0; r < config.rows; r++) {
+                if (a[(size_t)r * bit_packed::LANES + lane] != b[(size_t)r * bit_packed::LANES + lane])
+                    return false;
+            }
+            return true;
+        }
+
+        int population(const uint64_t* cells, int lane) const {
+            int count = 0;
+            for (int r = 0; r < config.rows; r++)
+                count += bit_packed::popcount64(cells[(size_t)r * bit_packed::LANES + lane]);
+            return count;
+        }
+
+        const Config& config;
+        int period_limit;
+        int slots;
+        uint64_t col_mask;
+        std::vector<uint64_t> history;
+        std::vector<uint64_t> hashes;
+        std::vector<uint64_t> board;
+        std::vector<int> age;
+        std::vector<uint64_t> seed;
+        uint64_t step_count = 0;
+    };
+
+    Stats run_batch(const Config& config, uint64_t first_board, uint64_t board_count, const Sink& sink, int threads) {
+        Stats stats;
+        if (config.rows < 1 || config.cols < 1 || config.cols > 64 || config.max_generations < 1)
+            return stats;
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        StealingQueue queue(first_board, board_count, threads);
+        std::mutex sink_mutex;
+        auto start = std::chrono::steady_clock::now();
+
+#pragma omp parallel num_threads(threads)
+        {
+            int worker = omp_get_thread_num();
+            LaneGroup group(config);
+            std::vector<Result> finished;
+            finished.reserve(SINK_BATCH + bit_packed::LANES);
+            bool more = true;
+            for (;;) {
+                int running = 0;
+                for (int lane = 0; lane < bit_packed::LANES; lane++) {
+                    uint64_t board;
+                    if (!group.active(lane) && more) {
+                        more = queue.pop(worker, board);
+                        if (more)
+                            group.load(lane, board);
+                    }
+                    running += group.active(lane);
+                }
+                if (running == 0)
+                    break;
+                group.step(finished);
+                if (finished.size() >= SINK_BATCH) {
+                    if (sink) {
+                        std::lock_guard<std::mutex> lock(sink_mutex);
+                        sink(finished);
+                    }
+                    finished.clear();
+                }
+            }
+            if (sink && !finished.empty()) {
+                std::lock_guard<std::mutex> lock(sink_mutex);
+                sink(finished);
+            }
+        }
+
+        stats.boards = board_count;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.boards_per_second = stats.seconds > 0 ? board_count / stats.seconds : 0;
+        return stats;
+    }
+
+    //int main()
+    //{
+    //    Config config;
+    //    long long settled = 0;
+    //    Stats stats = run_batch(config, 0, 1000000, [&](const std::vector<Result>& results) {
+    //        for (const Result& result : results)
+    //            settled += result.period != 0;
+    //    });
+    //    std::cout << settled << " of " << stats.boards << " boards settled, "
+    //        << stats.boards_per_second << " boards/s (" << bit_packed::simd_path() << ")" << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,446 @@
+// life_benchmark.cpp
+// Compile: g++ -std=c++17 -O2 -march=native -fopenmp -o life_benchmark life_benchmark.cpp life_bitpacked.cpp
+//          life_halo_grid.cpp life_dirty_tiles.cpp life_temporal_blocking.cpp
+// Run examples:
+//   ./life_benchmark                                   (default sweep, writes life_benchmark.json)
+//   ./life_benchmark --sizes 512,2048 --threads 1,4,8 --engines bitpacked,halo --output release.json
+//   ./life_benchmark --densities 0.05,0.5 --boundaries finite --generations 200 --trials 7 --no-pin
+//
+// Every combination of size, density, boundary, thread count and engine is
+// warmed up, then timed generation by generation over several trials on the
+// same seeded start grid. The JSON report holds cell updates per second, the
+// median and p99 time per generation, and the bytes the engine's grids and
+// scratch buffers hold (not the process's resident set, which the allocator
+// and earlier runs distort). An
+// engine that steps in blocks of generations is timed per block, so its
+// samples are block averages and its p99 is left out (null).
+
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace life_benchmark {
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        std::vector<int> sizes = { 256, 1024, 4096 };
+        std::vector<double> densities = { 0.1, 0.5 };
+        std::vector<bool> boundaries = { true, false };
+        std::vector<int> threads = { 1, omp_get_max_threads() };
+        std::vector<std::string> engines = { "bitpacked", "halo", "tiles", "blocked" };
+        int generations = 100;
+        int warmup = 10;
+        int trials = 5;
+        uint64_t seed = 1;
+        bool pin = true;
+        std::string output = "life_benchmark.json";
+    };
+
+    struct Measurement {
+        std::string engine;
+        int size = 0;
+        double density = 0;
+        bool wrap = true;
+        int threads = 0;
+        bool pinned = false;                 // every thread of the team got its CPU
+        std::vector<double> generation_ns;   // per advance() call and generation, all trials
+        int generations_per_call = 1;        // most generations a single advance() call ran
+        std::vector<double> trial_seconds;
+        size_t footprint_bytes = 0;          // engine buffers after the last trial
+        long long population = 0;
+    };
+
+    // The engines behind one interface. advance() may run fewer generations
+    // than asked (temporal blocking runs whole blocks) and returns how many.
+    class Engine {
+    public:
+        virtual ~Engine() = default;
+        virtual void load(const std::vector<std::vector<int>>& matrix) = 0;
+        virtual int advance(int generations) = 0;
+        virtual long long population() const = 0;
+        virtual size_t footprint_bytes() const = 0;
+    };
+
+    static long long count_cells(const std::vector<std::vector<int>>& matrix) {
+        long long count = 0;
+        for (const auto& row : matrix)
+            for (int cell : row)
+                count += cell;
+        return count;
+    }
+
+    class BitPackedEngine : public Engine {
+    public:
+        BitPackedEngine(int rows, int cols, bool wrap) : current(rows, cols), next(rows, cols), wrap(wrap) {}
+        void load(const std::vector<std::vector<int>>& matrix) override { current = bit_packed::from_matrix(matrix); }
+        int advance(int) override {
+            bit_packed::calculate_next_generation(current, next, wrap);
+            std::swap(current, next);
+            return 1;
+        }
+        long long population() const override { return bit_packed::population(current); }
+        size_t footprint_bytes() const override {
+            return (current.words.capacity() + next.words.capacity()) * sizeof(uint64_t);
+        }
+
+    private:
+        bit_packed::BitGrid current, next;
+        bool wrap;
+    };
+
+    class HaloEngine : public Engine {
+    public:
+        HaloEngine(int rows, int cols, bool wrap) : generations(rows, cols), wrap(wrap) {}
+        void load(const std::vector<std::vector<int>>& matrix) override { halo_grid::load_matrix(generations.current(), matrix); }
+        int advance(int) override {
+            generations.step(wrap);
+            return 1;
+        }
+        long long population() const override { return count_cells(halo_grid::to_matrix(generations.current())); }
+        // both generations have the current one's shape
+        size_t footprint_bytes() const override { return 2 * generations.current().cells.capacity(); }
+
+    private:
+        halo_grid::DoubleBuffer generations;
+        bool wrap;
+    };
+
+    class TilesEngine : public Engine {
+    public:
+        TilesEngine(int rows, int cols, bool wrap) : life(rows, cols), wrap(wrap) {}
+        void load(const std::vector<std::vector<int>>& matrix) override { life.load_matrix(matrix); }
+        int advance(int) override {
+            life.step(wrap);
+            return 1;
+        }
+        long long population() const override { return count_cells(life.to_matrix()); }
+        size_t footprint_bytes() const override { return life.footprint_bytes(); }
+
+    private:
+        dirty_tiles::TiledLife life;
+        bool wrap;
+    };
+
+    class BlockedEngine : public Engine {
+    public:
+        BlockedEngine(int rows, int cols, bool wrap) : life(rows, cols), wrap(wrap) {}
+        void load(const std::vector<std::vector<int>>& matrix) override { life.load_matrix(matrix); }
+        int advance(int generations) override {
+            int block = std::min(generations, life.parameters().generations_per_block);
+            life.advance(block, wrap);
+            return block;
+        }
+        long long population() const override { return count_cells(life.to_matrix()); }
+        size_t footprint_bytes() const override { return life.footprint_bytes(); }
+
+    private:
+        temporal_blocking::BlockedLife life;
+        bool wrap;
+    };
+
+    static std::unique_ptr<Engine> make_engine(const std::string& name, int rows, int cols, bool wrap) {
+        if (name == "bitpacked")
+            return std::unique_ptr<Engine>(new BitPackedEngine(rows, cols, wrap));
+        if (name == "halo")
+            return std::unique_ptr<Engine>(new HaloEngine(rows, cols, wrap));
+        if (name == "tiles")
+            return std::unique_ptr<Engine>(new TilesEngine(rows, cols, wrap));
+        if (name == "blocked")
+            return std::unique_ptr<Engine>(new BlockedEngine(rows, cols, wrap));
+        return nullptr;
+    }
+
+    // CPUs this process may run on, read before any thread is pinned (on
+    // Linux the calling thread's mask is what sched_getaffinity returns).
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+#ifdef _WIN32
+        DWORD_PTR process_mask = 0, system_mask = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+            for (int cpu = 0; cpu < (int)(8 * sizeof(DWORD_PTR)); cpu++)
+                if (process_mask & ((DWORD_PTR)1 << cpu))
+                    cpus.push_back(cpu);
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+#endif
+        return cpus;
+    }
+
+    static bool pin_current_thread(int cpu) {
+#ifdef _WIN32
+        return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+    }
+
+    // OpenMP keeps its thread pool between parallel regions, so pinning the
+    // pool once per thread count holds for every engine that runs with it.
+    // Threads take the allowed CPUs in order, wrapping when there are more
+    // threads than CPUs. Returns whether the whole team was pinned.
+    static bool pin_threads(int threads, const std::vector<int>& cpus) {
+        if (cpus.empty())
+            return false;
+        int pinned = 0;
+        int team = 0;
+#pragma omp parallel num_threads(threads) reduction(+:pinned)
+        {
+            if (pin_current_thread(cpus[omp_get_thread_num() % cpus.size()]))
+                pinned++;
+#pragma omp master
+            team = omp_get_num_threads();
+        }
+        return team == threads && pinned == threads;
+    }
+
+    static std::vector<std::vector<int>> start_grid(int size, double density, uint64_t seed) {
+        std::mt19937_64 generator(seed);
+        std::bernoulli_distribution alive(density);
+        std::vector<std::vector<int>> matrix(size, std::vector<int>(size));
+        for (auto& row : matrix)
+            for (int& cell : row)
+                cell = alive(generator) ? 1 : 0;
+        return matrix;
+    }
+
+    static Measurement measure(const Settings& settings, const std::string& name, int size, double density,
+        bool wrap, int threads, bool pinned, const std::vector<std::vector<int>>& start) {
+        Measurement m;
+        m.engine = name;
+        m.size = size;
+        m.density = density;
+        m.wrap = wrap;
+        m.threads = threads;
+        m.pinned = pinned;
+
+        std::unique_ptr<Engine> engine = make_engine(name, size, size, wrap);
+        for (int trial = 0; trial < settings.trials; trial++) {
+            engine->load(start);
+            for (int g = 0; g < settings.warmup; )
+                g += engine->advance(settings.warmup - g);
+
+            Clock::time_point trial_start = Clock::now();
+            for (int g = 0; g < settings.generations; ) {
+                Clock::time_point step_start = Clock::now();
+                int done = engine->advance(settings.generations - g);
+                double ns = std::chrono::duration<double, std::nano>(Clock::now() - step_start).count();
+                m.generation_ns.push_back(ns / done);
+                m.generations_per_call = std::max(m.generations_per_call, done);
+                g += done;
+            }
+            m.trial_seconds.push_back(std::chrono::duration<double>(Clock::now() - trial_start).count());
+        }
+        m.population = engine->population();
+        m.footprint_bytes = engine->footprint_bytes();
+        return m;
+    }
+
+    static double percentile(std::vector<double> samples, double fraction) {
+        if (samples.empty())
+            return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t index = (size_t)std::ceil(fraction * samples.size());
+        return samples[std::min(samples.size() - 1, index == 0 ? 0 : index - 1)];
+    }
+
+    static std::string json_string(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            if ((unsigned char)c < 0x20)
+                continue;
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    static std::string compiler() {
+#if defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#elif defined(__VERSION__)
+        return __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    static bool write_report(const Settings& settings, const std::vector<Measurement>& results) {
+        std::ofstream out(settings.output);
+        if (!out)
+            return false;
+        char timestamp[32];
+        std::time_t now = std::time(NULL);
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        out.precision(6);
+        out << "{\n";
+        out << "  \"benchmark\": \"game_of_life\",\n";
+        out << "  \"format_version\": 4,\n";
+        out << "  \"timestamp\": " << json_string(timestamp) << ",\n";
+        out << "  \"machine\": { \"processors\": " << omp_get_num_procs()
+            << ", \"simd\": " << json_string(bit_packed::simd_path())
+            << ", \"compiler\": " << json_string(compiler()) << " },\n";
+        out << "  \"settings\": { \"generations\": " << settings.generations << ", \"warmup\": " << settings.warmup
+            << ", \"trials\": " << settings.trials << ", \"seed\": " << settings.seed
+            << ", \"pin_requested\": " << (settings.pin ? "true" : "false") << " },\n";
+        out << "  \"results\": [";
+        for (size_t r = 0; r < results.size(); r++) {
+            const Measurement& m = results[r];
+            double cells = (double)m.size * m.size * settings.generations;
+            std::vector<double> rates;
+            for (double seconds : m.trial_seconds)
+                rates.push_back(seconds > 0 ? cells / seconds : 0);
+            out << (r == 0 ? "\n" : ",\n");
+            out << "    { \"engine\": " << json_string(m.engine) << ", \"rows\": " << m.size << ", \"cols\": " << m.size
+                << ", \"density\": " << m.density << ", \"boundary\": " << json_string(m.wrap ? "wrap" : "finite")
+                << ", \"threads\": " << m.threads << ", \"pinned\": " << (m.pinned ? "true" : "false") << ",\n";
+            out << "      \"cell_updates_per_second\": { \"median\": " << percentile(rates, 0.5)
+                << ", \"best\": " << *std::max_element(rates.begin(), rates.end()) << " },\n";
+            // a block average hides the slow generations a p99 is meant to show
+            out << "      \"generation_ns\": { \"median\": " << percentile(m.generation_ns, 0.5) << ", \"p99\": ";
+            if (m.generations_per_call == 1)
+                out << percentile(m.generation_ns, 0.99);
+            else
+                out << "null";
+            out << ", \"min\": " << percentile(m.generation_ns, 0)
+                << ", \"max\": " << percentile(m.generation_ns, 1)
+                << ", \"generations_per_sample\": " << m.generations_per_call << " },\n";
+            out << "      \"trial_seconds\": [";
+            for (size_t t = 0; t < m.trial_seconds.size(); t++)
+                out << (t ? ", " : "") << m.trial_seconds[t];
+            out << "],\n";
+            out << "      \"footprint_bytes\": " << m.footprint_bytes << ", \"final_population\": " << m.population << " }";
+        }
+        out << "\n  ]\n}\n";
+        return (bool)out;
+    }
+
+    template <typename T, typename Parse>
+    static std::vector<T> parse_list(const std::string& text, Parse parse) {
+        std::vector<T> values;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            if (!item.empty())
+                values.push_back(parse(item));
+        return values;
+    }
+
+    static void print_usage() {
+        std::cerr << "Usage: life_benchmark [--sizes N,...] [--densities P,...] [--boundaries wrap,finite]\n"
+            << "                      [--threads T,...] [--engines bitpacked,halo,tiles,blocked]\n"
+            << "                      [--generations G] [--warmup W] [--trials K] [--seed S]\n"
+            << "                      [--no-pin] [--output FILE]\n";
+    }
+
+    static bool parse_arguments(int argc, char** argv, Settings& settings) {
+        for (int a = 1; a < argc; a++) {
+            std::string option = argv[a];
+            if (option == "--no-pin") {
+                settings.pin = false;
+                continue;
+            }
+            if (a + 1 >= argc)
+                return false;
+            std::string value = argv[++a];
+            if (option == "--sizes")
+                settings.sizes = parse_list<int>(value, [](const std::string& s) { return std::stoi(s); });
+            else if (option == "--densities")
+                settings.densities = parse_list<double>(value, [](const std::string& s) { return std::stod(s); });
+            else if (option == "--boundaries")
+                settings.boundaries = parse_list<bool>(value, [](const std::string& s) { return s != "finite"; });
+            else if (option == "--threads")
+                settings.threads = parse_list<int>(value, [](const std::string& s) { return std::stoi(s); });
+            else if (option == "--engines")
+                settings.engines = parse_list<std::string>(value, [](const std::string& s) { return s; });
+            else if (option == "--generations")
+                settings.generations = std::stoi(value);
+            else if (option == "--warmup")
+                settings.warmup = std::stoi(value);
+            else if (option == "--trials")
+                settings.trials = std::stoi(value);
+            else if (option == "--seed")
+                settings.seed = std::stoull(value);
+            else if (option == "--output")
+                settings.output = value;
+            else
+                return false;
+        }
+        for (const std::string& engine : settings.engines)
+            if (!make_engine(engine, 1, 1, true))
+                return false;
+        return settings.generations > 0 && settings.warmup >= 0 && settings.trials > 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace life_benchmark;
+    Settings settings;
+    try {
+        if (!parse_arguments(argc, argv, settings)) {
+            print_usage();
+            return 1;
+        }
+    }
+    catch (const std::exception&) {
+        print_usage();
+        return 1;
+    }
+    std::sort(settings.threads.begin(), settings.threads.end());
+    settings.threads.erase(std::unique(settings.threads.begin(), settings.threads.end()), settings.threads.end());
+
+    std::vector<int> cpus = allowed_cpus();
+    std::vector<Measurement> results;
+    for (int threads : settings.threads) {
+        omp_set_num_threads(threads);
+        bool pinned = settings.pin && pin_threads(threads, cpus);
+        if (settings.pin && !pinned)
+            std::cerr << "Could not pin all " << threads << " threads; their results are marked unpinned\n";
+        for (int size : settings.sizes) {
+            for (double density : settings.densities) {
+                std::vector<std::vector<int>> start = start_grid(size, density, settings.seed);
+                for (bool wrap : settings.boundaries) {
+                    for (const std::string& engine : settings.engines) {
+                        results.push_back(measure(settings, engine, size, density, wrap, threads, pinned, start));
+                        const Measurement& m = results.back();
+                        std::cerr << engine << " " << size << "x" << size << " p=" << density
+                            << (wrap ? " wrap" : " finite") << " threads=" << threads
+                            << ": median " << percentile(m.generation_ns, 0.5) / 1000 << " us/generation\n";
+                    }
+                }
+            }
+        }
+    }
+
+    if (!write_report(settings, results)) {
+        std::cerr << "Could not write " << settings.output << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << results.size() << " results to " << settings.output << "\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "game_of_life.h"
+#include "life_rules.h"
+#include "bit_sliced.h"
+#include <omp.h>
+
+namespace bit_packed {
+    BitGrid::BitGrid(int rows, int cols)
+        : rows(rows), cols(cols), words_per_row((cols + 63) / 64),
+          words((size_t)(rows + 1) * ((cols + 63) / 64), 0) {
+    }
+
+    uint64_t BitGrid::last_word_mask() const {
+        int used = cols % 64;
+        return used == 0 ? ~0ULL : (1ULL << used) - 1;
+    }
+
+    int BitGrid::get(int i, int j) const {
+        return (int)((row(i)[j / 64] >> (j % 64)) & 1);
+    }
+
+    void BitGrid::set(int i, int j, int value) {
+        uint64_t bit = 1ULL << (j % 64);
+        if (value)
+            row(i)[j / 64] |= bit;
+        else
+            row(i)[j / 64] &= ~bit;
+    }
+
+    BitGrid from_matrix(const std::vector<std::vector<int>>& matrix) {
+        int rows = (int)matrix.size();
+        int cols = rows == 0 ? 0 : (int)matrix[0].size();
+        BitGrid grid(rows, cols);
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                if (matrix[i][j])
+                    grid.set(i, j, 1);
+            }
+        }
+        return grid;
+    }
+
+    std::vector<std::vector<int>> to_matrix(const BitGrid& grid) {
+        std::vector<std::vector<int>> matrix(grid.rows, std::vector<int>(grid.cols));
+        for (int i = 0; i < grid.rows; i++) {
+            for (int j = 0; j < grid.cols; j++) {
+                matrix[i][j] = grid.get(i, j);
+            }
+        }
+        return matrix;
+    }
+
+    long long population(const BitGrid& grid) {
+        long long count = 0;
+        for (int i = 0; i < grid.rows; i++) {
+            const uint64_t* r = grid.row(i);
+            for (int w = 0; w < grid.words_per_row; w++)
+                count += popcount64(r[w]);
+        }
+        return count;
+    }
+
+    const char* simd_path() { return SIMD_PATH; }
+
+    // West neighbour of every bit of word w, i.e. the row shifted one column right.
+    static inline uint64_t west_word(const uint64_t* r, int w, int words, int last_bit, bool wrap) {
+        uint64_t carry;
+        if (w > 0)
+            carry = r[w - 1] >> 63;
+        else
+            carry = wrap ? (r[words - 1] >> last_bit) & 1 : 0;
+        return (r[w] << 1) | carry;
+    }
+
+    static inline uint64_t east_word(const uint64_t* r, int w, int words, int last_bit, bool wrap) {
+        uint64_t value = r[w] >> 1;
+        if (w + 1 < words)
+            value |= r[w + 1] << 63;
+        else if (wrap)
+            value |= (r[0] & 1) << last_bit;
+        return value;
+    }
+
+    template <typename Rule>
+    static inline uint64_t next_word(const Rule& rule, const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+        int w, int words, int last_bit, bool wrap) {
+        return rule(
+            west_word(up, w, words, last_bit, wrap), up[w], east_word(up, w, words, last_bit, wrap),
+            west_word(mid, w, words, last_bit, wrap), mid[w], east_word(mid, w, words, last_bit, wrap),
+            west_word(down, w, words, last_bit, wrap), down[w], east_word(down, w, words, last_bit, wrap));
+    }
+
+    template <typename Rule>
+    static void next_row(const Rule& rule, const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+        int words, int last_bit, uint64_t last_mask, bool wrap) {
+        int w = 0;
+        out[w] = next_word(rule, up, mid, down, w, words, last_bit, wrap);
+        w++;
+#if defined(__AVX512F__) || defined(__AVX2__)
+        // Interior words have both neighbouring words in the same row, so their
+        // carries are plain shifted loads and no boundary handling is needed.
+        for (; w + LANES < words; w += LANES) {
+            vec u = vec::load(up + w), ul = vec::load(up + w - 1), ur = vec::load(up + w + 1);
+            vec m = vec::load(mid + w), ml = vec::load(mid + w - 1), mr = vec::load(mid + w + 1);
+            vec d = vec::load(down + w), dl = vec::load(down + w - 1), dr = vec::load(down + w + 1);
+            rule(
+                u.shl1() | ul.shr63(), u, u.shr1() | ur.shl63(),
+                m.shl1() | ml.shr63(), m, m.shr1() | mr.shl63(),
+                d.shl1() | dl.shr63(), d, d.shr1() | dr.shl63()).store(out + w);
+        }
+#endif
+        for (; w < words; w++)
+            out[w] = next_word(rule, up, mid, down, w, words, last_bit, wrap);
+        out[words - 1] &= last_mask;
+    }
+
+    void calculate_next_row(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+        int cols, bool wrap) {
+        int words = (cols + 63) / 64;
+        uint64_t last_mask = cols % 64 == 0 ? ~0ULL : (1ULL << (cols % 64)) - 1;
+        next_row(ConwayRule(), up, mid, down, out, words, (cols - 1) % 64, last_mask, wrap);
+    }
+
+    template <typename Rule>
+    static void calculate_with_rule(const Rule& rule, const BitGrid& current, BitGrid& next, bool wrap) {
+        int rows = current.rows;
+        int words = current.words_per_row;
+        if (rows == 0 || words == 0)
+            return;
+        int last_bit = (current.cols - 1) % 64;
+        uint64_t last_mask = current.last_word_mask();
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < rows; i++) {
+            const uint64_t* up = i > 0 ? current.row(i - 1) : (wrap ? current.row(rows - 1) : current.zero_row());
+            const uint64_t* down = i + 1 < rows ? current.row(i + 1) : (wrap ? current.row(0) : current.zero_row());
+            next_row(rule, up, current.row(i), down, next.row(i), words, last_bit, last_mask, wrap);
+        }
+    }
+
+    void calculate_next_generation(const BitGrid& current, BitGrid& next, bool wrap) {
+        calculate_with_rule(ConwayRule(), current, next, wrap);
+    }
+
+    template <typename R>
+    static bool calculate_if_builtin(uint16_t birth, uint16_t survive, const BitGrid& current, BitGrid& next,
+        bool wrap) {
+        if (birth != R::rule.birth || survive != R::rule.survive)
+            return false;
+        calculate_with_rule(SlicedRule<StaticMasks<R::rule.birth, R::rule.survive>>(), current, next, wrap);
+        return true;
+    }
+
+    void calculate_next_generation(const BitGrid& current, BitGrid& next, bool wrap, uint16_t birth,
+        uint16_t survive) {
+        if (birth == life_rules::Conway::rule.birth && survive == life_rules::Conway::rule.survive)
+            calculate_with_rule(ConwayRule(), current, next, wrap);
+        else if (!calculate_if_builtin<life_rules::HighLife>(birth, survive, current, next, wrap)
+            && !calculate_if_builtin<life_rules::DayAndNight>(birth, survive, current, next, wrap)
+            && !calculate_if_builtin<life_rules::Seeds>(birth, survive, current, next, wrap))
+            calculate_with_rule(SlicedRule<RuntimeMasks>{ { birth, survive } }, current, next, wrap);
+    }
+
+    //int main()
+    //{
+    //    BitGrid current = from_matrix(multi_core::generate_start_values());
+    //    BitGrid next(current.rows, current.cols);
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    for (int iteration = 0; iteration < 100; iteration++) {
+    //        calculate_next_generation(current, next, true);
+    //        std::swap(current, next);
+    //    }
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << simd_path() << " time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
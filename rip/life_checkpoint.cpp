@@ -0,0 +1,351 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace checkpoint {
+    const char MAGIC[8] = { 'L', 'I', 'F', 'E', 'C', 'K', 'P', 'T' };
+    const uint32_t VERSION = 1;
+    const size_t HEADER_BYTES = 48;
+    const size_t DIRECTORY_ENTRY_BYTES = 24;
+    const size_t IO_BLOCK_BYTES = (size_t)1 << 30;
+
+    enum Encoding : uint32_t {
+        RAW = 0,
+        ZERO_RUNS = 1,
+    };
+
+    struct TileEntry {
+        uint64_t offset;
+        uint64_t bytes;
+        uint32_t encoding;
+    };
+
+    // Positional reads and writes on one handle, so tiles can be transferred by
+    // several threads at once without sharing a file position.
+    class File {
+    public:
+        File(const char* path, bool write) {
+#ifdef _WIN32
+            handle = write
+                ? CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL)
+                : CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+            fd = write ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+#endif
+        }
+
+        ~File() {
+            close();
+        }
+
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        bool ok() const {
+#ifdef _WIN32
+            return handle != INVALID_HANDLE_VALUE;
+#else
+            return fd >= 0;
+#endif
+        }
+
+        bool write_at(const void* data, size_t bytes, uint64_t offset) {
+            const char* p = (const char*)data;
+            while (bytes > 0) {
+                size_t block = std::min(bytes, IO_BLOCK_BYTES);
+#ifdef _WIN32
+                OVERLAPPED at = {};
+                at.Offset = (DWORD)offset;
+                at.OffsetHigh = (DWORD)(offset >> 32);
+                DWORD done = 0;
+                if (!WriteFile(handle, p, (DWORD)block, &done, &at) || done == 0)
+                    return false;
+#else
+                ssize_t done = pwrite(fd, p, block, (off_t)offset);
+                if (done <= 0)
+                    return false;
+#endif
+                p += done;
+                bytes -= done;
+                offset += done;
+            }
+            return true;
+        }
+
+        bool read_at(void* data, size_t bytes, uint64_t offset) {
+            char* p = (char*)data;
+            while (bytes > 0) {
+                size_t block = std::min(bytes, IO_BLOCK_BYTES);
+#ifdef _WIN32
+                OVERLAPPED at = {};
+                at.Offset = (DWORD)offset;
+                at.OffsetHigh = (DWORD)(offset >> 32);
+                DWORD done = 0;
+                if (!ReadFile(handle, p, (DWORD)block, &done, &at) || done == 0)
+                    return false;
+#else
+                ssize_t done = pread(fd, p, block, (off_t)offset);
+                if (done <= 0)
+                    return false;
+#endif
+                p += done;
+                bytes -= done;
+                offset += done;
+            }
+            return true;
+        }
+
+        bool sync() {
+#ifdef _WIN32
+            return FlushFileBuffers(handle) != 0;
+#else
+            return fsync(fd) == 0;
+#endif
+        }
+
+        bool close() {
+            bool closed = true;
+#ifdef _WIN32
+            if (handle != INVALID_HANDLE_VALUE)
+                closed = CloseHandle(handle) != 0;
+            handle = INVALID_HANDLE_VALUE;
+#else
+            if (fd >= 0)
+                closed = ::close(fd) == 0;
+            fd = -1;
+#endif
+            return closed;
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+        int fd = -1;
+#endif
+    };
+
+    static bool replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+        return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from, to) == 0;
+#endif
+    }
+
+    template <typename T>
+    static void put(std::vector<char>& out, size_t& at, T value) {
+        std::memcpy(out.data() + at, &value, sizeof(T));
+        at += sizeof(T);
+    }
+
+    template <typename T>
+    static T get(const std::vector<char>& in, size_t& at) {
+        T value;
+        std::memcpy(&value, in.data() + at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    // Zero-run coding of packed words: a control word holding the number of zero
+    // words (high half) and of literal words that follow it (low half), then the
+    // literals. Life boards are mostly empty, so this is cheap and effective
+    // without pulling in a compression library.
+    static void encode_zero_runs(const uint64_t* words, size_t count, std::vector<uint64_t>& out) {
+        out.clear();
+        size_t w = 0;
+        while (w < count) {
+            size_t zeros = 0;
+            while (w < count && words[w] == 0 && zeros < UINT32_MAX) {
+                zeros++;
+                w++;
+            }
+            size_t first = w;
+            while (w < count && words[w] != 0 && w - first < UINT32_MAX)
+                w++;
+            out.push_back(((uint64_t)zeros << 32) | (uint64_t)(w - first));
+            out.insert(out.end(), words + first, words + w);
+        }
+    }
+
+    static bool decode_zero_runs(const uint64_t* in, size_t count, uint64_t* words, size_t expected) {
+        size_t w = 0;
+        size_t i = 0;
+        while (i < count) {
+            size_t zeros = (size_t)(in[i] >> 32);
+            size_t literals = (size_t)(in[i] & 0xffffffffULL);
+            i++;
+            if (zeros > expected - w || literals > expected - w - zeros || literals > count - i)
+                return false;
+            std::memset(words + w, 0, zeros * sizeof(uint64_t));
+            w += zeros;
+            std::memcpy(words + w, in + i, literals * sizeof(uint64_t));
+            w += literals;
+            i += literals;
+        }
+        return w == expected;
+    }
+
+    bool write_checkpoint(const char* path, const bit_packed::BitGrid& grid, uint64_t generation,
+        bool compress, int tile_rows) {
+        tile_rows = std::max(tile_rows, 1);
+        int tile_count = (grid.rows + tile_rows - 1) / tile_rows;
+        std::vector<std::vector<uint64_t>> encoded(tile_count);
+        std::vector<TileEntry> tiles(tile_count);
+
+        // encode every tile first, the offsets depend on all earlier tile sizes
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int t = 0; t < tile_count; t++) {
+            int rows = std::min(tile_rows, grid.rows - t * tile_rows);
+            size_t words = (size_t)rows * grid.words_per_row;
+            tiles[t].encoding = RAW;
+            tiles[t].bytes = words * sizeof(uint64_t);
+            if (compress) {
+                encode_zero_runs(grid.row(t * tile_rows), words, encoded[t]);
+                if (encoded[t].size() < words) {
+                    tiles[t].encoding = ZERO_RUNS;
+                    tiles[t].bytes = encoded[t].size() * sizeof(uint64_t);
+                }
+                else {
+                    std::vector<uint64_t>().swap(encoded[t]);
+                }
+            }
+        }
+
+        std::vector<char> header(HEADER_BYTES + (size_t)tile_count * DIRECTORY_ENTRY_BYTES);
+        uint64_t offset = header.size();
+        for (TileEntry& tile : tiles) {
+            tile.offset = offset;
+            offset += tile.bytes;
+        }
+        size_t at = 0;
+        std::memcpy(header.data(), MAGIC, 8);
+        at += 8;
+        put<uint32_t>(header, at, VERSION);
+        put<uint32_t>(header, at, (uint32_t)tile_rows);
+        put<uint64_t>(header, at, (uint64_t)grid.rows);
+        put<uint64_t>(header, at, (uint64_t)grid.cols);
+        put<uint64_t>(header, at, generation);
+        put<uint64_t>(header, at, (uint64_t)tile_count);
+        for (const TileEntry& tile : tiles) {
+            put<uint64_t>(header, at, tile.offset);
+            put<uint64_t>(header, at, tile.bytes);
+            put<uint32_t>(header, at, tile.encoding);
+            put<uint32_t>(header, at, 0);
+        }
+
+        // written next to the old checkpoint and renamed over it once complete,
+        // so a run preempted mid-write still has the previous one
+        std::string scratch = std::string(path) + ".tmp";
+        File file(scratch.c_str(), true);
+        if (!file.ok())
+            return false;
+        bool ok = file.write_at(header.data(), header.size(), 0);
+        int failed = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+        for (int t = 0; t < tile_count; t++) {
+            const void* data = tiles[t].encoding == RAW ? (const void*)grid.row(t * tile_rows) : (const void*)encoded[t].data();
+            if (!file.write_at(data, (size_t)tiles[t].bytes, tiles[t].offset))
+                failed |= 1;
+        }
+        ok = ok && !failed && file.sync();
+        ok = file.close() && ok;
+        if (!ok || !replace_file(scratch.c_str(), path)) {
+            std::remove(scratch.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool read_checkpoint(const char* path, bit_packed::BitGrid& grid, uint64_t& generation) {
+        File file(path, false);
+        if (!file.ok())
+            return false;
+        std::vector<char> header(HEADER_BYTES);
+        if (!file.read_at(header.data(), header.size(), 0) || std::memcmp(header.data(), MAGIC, 8) != 0)
+            return false;
+        size_t at = 8;
+        uint32_t version = get<uint32_t>(header, at);
+        uint32_t tile_rows = get<uint32_t>(header, at);
+        uint64_t rows = get<uint64_t>(header, at);
+        uint64_t cols = get<uint64_t>(header, at);
+        uint64_t stored_generation = get<uint64_t>(header, at);
+        uint64_t tile_count = get<uint64_t>(header, at);
+        if (version != VERSION || tile_rows == 0 || rows >= INT32_MAX || cols >= INT32_MAX
+            || tile_count != (rows + tile_rows - 1) / tile_rows)
+            return false;
+
+        std::vector<char> directory((size_t)tile_count * DIRECTORY_ENTRY_BYTES);
+        if (!file.read_at(directory.data(), directory.size(), HEADER_BYTES))
+            return false;
+        std::vector<TileEntry> tiles((size_t)tile_count);
+        at = 0;
+        for (TileEntry& tile : tiles) {
+            tile.offset = get<uint64_t>(directory, at);
+            tile.bytes = get<uint64_t>(directory, at);
+            tile.encoding = get<uint32_t>(directory, at);
+            at += 4;
+        }
+
+        bit_packed::BitGrid restored((int)rows, (int)cols);
+        int failed = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+        for (int t = 0; t < (int)tile_count; t++) {
+            const TileEntry& tile = tiles[t];
+            int tile_begin = t * (int)tile_rows;
+            size_t words = (size_t)std::min((int)tile_rows, restored.rows - tile_begin) * restored.words_per_row;
+            uint64_t* target = restored.row(tile_begin);
+            if (tile.encoding == RAW) {
+                if (tile.bytes != words * sizeof(uint64_t) || !file.read_at(target, (size_t)tile.bytes, tile.offset))
+                    failed |= 1;
+            }
+            else if (tile.encoding == ZERO_RUNS && tile.bytes % sizeof(uint64_t) == 0
+                && tile.bytes <= words * sizeof(uint64_t)) {
+                std::vector<uint64_t> encoded((size_t)(tile.bytes / sizeof(uint64_t)));
+                if (!file.read_at(encoded.data(), (size_t)tile.bytes, tile.offset)
+                    || !decode_zero_runs(encoded.data(), encoded.size(), target, words))
+                    failed |= 1;
+            }
+            else {
+                failed |= 1;
+            }
+        }
+        if (failed)
+            return false;
+        // a corrupt tile must not leave cells in the padding bits
+        if (restored.words_per_row > 0) {
+            uint64_t mask = restored.last_word_mask();
+            for (int i = 0; i < restored.rows; i++)
+                restored.row(i)[restored.words_per_row - 1] &= mask;
+        }
+        grid = std::move(restored);
+        generation = stored_generation;
+        return true;
+    }
+
+    //int main()
+    //{
+    //    bit_packed::BitGrid current = bit_packed::from_matrix(multi_core::generate_start_values());
+    //    bit_packed::BitGrid next(current.rows, current.cols);
+    //    uint64_t generation = 0;
+    //    read_checkpoint("life.ckpt", current, generation);
+    //    next = bit_packed::BitGrid(current.rows, current.cols);
+    //    for (; generation < (uint64_t)multi_core::NUMBER_OF_ITERATIONS; generation++) {
+    //        if (generation % 100 == 0)
+    //            write_checkpoint("life.ckpt", current, generation);
+    //        bit_packed::calculate_next_generation(current, next, true);
+    //        std::swap(current, next);
+    //    }
+    //    return 0;
+    //}
+}
\ No newline at end of file
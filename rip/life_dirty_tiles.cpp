@@ -0,0 +1,107 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+
+namespace dirty_tiles {
+    TiledLife::TiledLife(int rows, int cols, int tile_size)
+        : buffers{ halo_grid::HaloGrid(rows, cols), halo_grid::HaloGrid(rows, cols) },
+          tile_size(tile_size),
+          tiles_x((cols + tile_size - 1) / tile_size),
+          tiles_y((rows + tile_size - 1) / tile_size),
+          changed(tiles_x * tiles_y, 1),
+          next_changed(tiles_x * tiles_y, 0) {
+        active.reserve(tiles_x * tiles_y);
+    }
+
+    void TiledLife::load_matrix(const std::vector<std::vector<int>>& matrix) {
+        halo_grid::load_matrix(buffers[0], matrix);
+        halo_grid::load_matrix(buffers[1], matrix);
+        front = 0;
+        std::fill(changed.begin(), changed.end(), 1);
+    }
+
+    std::vector<std::vector<int>> TiledLife::to_matrix() const {
+        return halo_grid::to_matrix(current());
+    }
+
+    size_t TiledLife::footprint_bytes() const {
+        return buffers[0].cells.capacity() + buffers[1].cells.capacity() + changed.capacity()
+            + next_changed.capacity() + active.capacity() * sizeof(int);
+    }
+
+    void TiledLife::collect_active_tiles(bool wrap) {
+        active.clear();
+        for (int ty = 0; ty < tiles_y; ty++) {
+            for (int tx = 0; tx < tiles_x; tx++) {
+                bool is_active = false;
+                for (int dy = -1; dy <= 1 && !is_active; dy++) {
+                    for (int dx = -1; dx <= 1 && !is_active; dx++) {
+                        int ny = ty + dy;
+                        int nx = tx + dx;
+                        if (wrap) {
+                            ny = (ny + tiles_y) % tiles_y;
+                            nx = (nx + tiles_x) % tiles_x;
+                        }
+                        else if (ny < 0 || ny >= tiles_y || nx < 0 || nx >= tiles_x) {
+                            continue;
+                        }
+                        is_active = changed[ny * tiles_x + nx] != 0;
+                    }
+                }
+                if (is_active)
+                    active.push_back(ty * tiles_x + tx);
+            }
+        }
+    }
+
+    // Writes the tile's next generation into the back buffer and reports whether
+    // any of its cells flipped.
+    bool TiledLife::calculate_tile(int tile) {
+        const halo_grid::HaloGrid& cur = buffers[front];
+        halo_grid::HaloGrid& next = buffers[1 - front];
+        int row_begin = (tile / tiles_x) * tile_size;
+        int col_begin = (tile % tiles_x) * tile_size;
+        int row_end = std::min(row_begin + tile_size, cur.rows);
+        int col_end = std::min(col_begin + tile_size, cur.cols);
+        uint8_t flipped = 0;
+        for (int i = row_begin; i < row_end; i++) {
+            const uint8_t* up = cur.row(i - 1);
+            const uint8_t* mid = cur.row(i);
+            const uint8_t* down = cur.row(i + 1);
+            uint8_t* out = next.row(i);
+            for (int j = col_begin; j < col_end; j++) {
+                int live_neighbours = up[j - 1] + up[j] + up[j + 1]
+                    + mid[j - 1] + mid[j + 1]
+                    + down[j - 1] + down[j] + down[j + 1];
+                out[j] = halo_grid::CONWAY_RULE[mid[j]][live_neighbours];
+                flipped |= out[j] ^ mid[j];
+            }
+        }
+        return flipped != 0;
+    }
+
+    void TiledLife::step(bool wrap) {
+        buffers[front].fill_halo(wrap);
+        collect_active_tiles(wrap);
+        std::fill(next_changed.begin(), next_changed.end(), 0);
+        int active_count = (int)active.size();
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int t = 0; t < active_count; t++) {
+            int tile = active[t];
+            next_changed[tile] = calculate_tile(tile) ? 1 : 0;
+        }
+        changed.swap(next_changed);
+        front = 1 - front;
+    }
+
+    //int main()
+    //{
+    //    TiledLife life(multi_core::M, multi_core::N, 16);
+    //    life.load_matrix(multi_core::generate_start_values());
+    //    for (int iteration = 0; iteration < multi_core::NUMBER_OF_ITERATIONS; iteration++) {
+    //        life.step(false);
+    //        std::cout << "Active tiles: " << life.active_tile_count() << "/" << life.tile_count() << std::endl;
+    //    }
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+// life_distributed_memory.cpp
+// Compile: mpicxx -std=c++17 -O2 -o life_distributed_memory life_distributed_memory.cpp
+// Run examples:
+//   mpirun -np 4 ./life_distributed_memory                      (default 512x512, 100 gens, wrap)
+//   mpirun -np 6 ./life_distributed_memory 1000 700 200 finite 0.3 42
+//   mpirun -np 4 ./life_distributed_memory 97 61 50 wrap 0.3 7 verify
+//                                            (gathers on rank 0 and checks against a serial run)
+
+#include <mpi.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace distributed_life {
+    // next state indexed by [cell][live_neighbours], B3/S23
+    const uint8_t RULE[2][9] = {
+        { 0, 0, 0, 1, 0, 0, 0, 0, 0 },
+        { 0, 0, 1, 1, 0, 0, 0, 0, 0 },
+    };
+
+    enum Direction { UP, DOWN, LEFT, RIGHT, UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT, DIRECTIONS };
+    const int OPPOSITE[DIRECTIONS] = { DOWN, UP, RIGHT, LEFT, DOWN_RIGHT, DOWN_LEFT, UP_RIGHT, UP_LEFT };
+    const int DROW[DIRECTIONS] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const int DCOL[DIRECTIONS] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+    // Same split as the Warshall row decomposition: the first `remainder` parts
+    // get one extra element.
+    void split(int total, int parts, int index, int& begin, int& count) {
+        int base = total / parts;
+        int remainder = total % parts;
+        count = base + (index < remainder ? 1 : 0);
+        begin = index * base + (index < remainder ? index : remainder);
+    }
+
+    // Reproducible start value for global cell (i, j), independent of the
+    // decomposition, so every rank can seed its own block.
+    int start_value(int i, int j, double prob, uint64_t seed) {
+        uint64_t x = seed ^ ((uint64_t)(uint32_t)i << 32 | (uint32_t)j);
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return (double)(x >> 11) / (double)(1ULL << 53) < prob ? 1 : 0;
+    }
+
+    // One rank's block of a 2D Cartesian decomposition, stored with a one-cell
+    // halo and double buffered.
+    class Subdomain {
+    public:
+        Subdomain(int global_rows, int global_cols, bool wrap, MPI_Comm comm) : global_rows(global_rows), global_cols(global_cols), wrap(wrap) {
+            int size;
+            MPI_Comm_size(comm, &size);
+            int dims[2] = { 0, 0 };
+            MPI_Dims_create(size, 2, dims);
+            int periods[2] = { wrap ? 1 : 0, wrap ? 1 : 0 };
+            MPI_Cart_create(comm, 2, dims, periods, 0, &cart);
+            MPI_Comm_rank(cart, &rank);
+            MPI_Cart_coords(cart, rank, 2, coords);
+            proc_rows = dims[0];
+            proc_cols = dims[1];
+            split(global_rows, proc_rows, coords[0], row0, rows);
+            split(global_cols, proc_cols, coords[1], col0, cols);
+            stride = cols + 2;
+            cells[0].assign((size_t)(rows + 2) * stride, 0);
+            cells[1].assign((size_t)(rows + 2) * stride, 0);
+
+            for (int d = 0; d < DIRECTIONS; d++) {
+                int target[2] = { coords[0] + DROW[d], coords[1] + DCOL[d] };
+                if (!wrap && (target[0] < 0 || target[0] >= proc_rows || target[1] < 0 || target[1] >= proc_cols)) {
+                    neighbours[d] = MPI_PROC_NULL;
+                    continue;
+                }
+                target[0] = (target[0] + proc_rows) % proc_rows;
+                target[1] = (target[1] + proc_cols) % proc_cols;
+                MPI_Cart_rank(cart, target, &neighbours[d]);
+            }
+            MPI_Type_vector(rows, 1, stride, MPI_UINT8_T, &column_type);
+            MPI_Type_commit(&column_type);
+        }
+
+        ~Subdomain() {
+            MPI_Type_free(&column_type);
+            MPI_Comm_free(&cart);
+        }
+
+        int get_rank() const { return rank; }
+        uint8_t* cell(int buffer, int i, int j) { return cells[buffer].data() + (size_t)(i + 1) * stride + j + 1; }
+
+        void seed(double prob, uint64_t seed) {
+            for (int i = 0; i < rows; i++)
+                for (int j = 0; j < cols; j++)
+                    *cell(front, i, j) = (uint8_t)start_value(row0 + i, col0 + j, prob, seed);
+        }
+
+        void step() {
+            MPI_Request requests[2 * DIRECTIONS];
+            post_halo_exchange(requests);
+            // the interior does not read the halo, so it overlaps the exchange
+            calculate(1, rows - 1, 1, cols - 1);
+            MPI_Waitall(2 * DIRECTIONS, requests, MPI_STATUSES_IGNORE);
+            calculate(0, 1, 0, cols);
+            if (rows > 1)
+                calculate(rows - 1, rows, 0, cols);
+            calculate(1, rows - 1, 0, 1);
+            if (cols > 1)
+                calculate(1, rows - 1, cols - 1, cols);
+            front = 1 - front;
+        }
+
+        // Full grid on root, empty elsewhere.
+        std::vector<std::vector<int>> gather(int root) {
+            int size;
+            MPI_Comm_size(cart, &size);
+            std::vector<uint8_t> block((size_t)rows * cols);
+            for (int i = 0; i < rows; i++)
+                std::memcpy(block.data() + (size_t)i * cols, cell(front, i, 0), cols);
+            std::vector<int> counts(size), displs(size);
+            int local = rows * cols;
+            MPI_Gather(&local, 1, MPI_INT, counts.data(), 1, MPI_INT, root, cart);
+            std::vector<uint8_t> all;
+            if (rank == root) {
+                int total = 0;
+                for (int r = 0; r < size; r++) {
+                    displs[r] = total;
+                    total += counts[r];
+                }
+                all.resize(total);
+            }
+            MPI_Gatherv(block.data(), local, MPI_UINT8_T, all.data(), counts.data(), displs.data(), MPI_UINT8_T, root, cart);
+
+            std::vector<std::vector<int>> matrix;
+            if (rank != root)
+                return matrix;
+            matrix.assign(global_rows, std::vector<int>(global_cols));
+            for (int r = 0; r < size; r++) {
+                int c[2], r_row0, r_rows, r_col0, r_cols;
+                MPI_Cart_coords(cart, r, 2, c);
+                split(global_rows, proc_rows, c[0], r_row0, r_rows);
+                split(global_cols, proc_cols, c[1], r_col0, r_cols);
+                const uint8_t* data = all.data() + displs[r];
+                for (int i = 0; i < r_rows; i++)
+                    for (int j = 0; j < r_cols; j++)
+                        matrix[r_row0 + i][r_col0 + j] = data[i * r_cols + j];
+            }
+            return matrix;
+        }
+
+    private:
+        // Sends the edge rows, columns and corners of the current generation and
+        // receives the neighbours' into the halo. Missing neighbours in finite
+        // mode are MPI_PROC_NULL, so those halo cells keep their zeros.
+        void post_halo_exchange(MPI_Request* requests) {
+            const int last_row = rows - 1, last_col = cols - 1;
+            for (int d = 0; d < DIRECTIONS; d++) {
+                // the edge of this block facing d, and the halo cells facing d
+                int edge_row = DROW[d] < 0 ? 0 : (DROW[d] > 0 ? last_row : 0);
+                int edge_col = DCOL[d] < 0 ? 0 : (DCOL[d] > 0 ? last_col : 0);
+                int halo_row = DROW[d] < 0 ? -1 : (DROW[d] > 0 ? rows : 0);
+                int halo_col = DCOL[d] < 0 ? -1 : (DCOL[d] > 0 ? cols : 0);
+                uint8_t* send = cell(front, edge_row, edge_col);
+                uint8_t* recv = cell(front, halo_row, halo_col);
+                MPI_Datatype type = MPI_UINT8_T;
+                int count = 1;
+                if (DCOL[d] == 0)
+                    count = cols;
+                else if (DROW[d] == 0)
+                    type = column_type;
+                // tag by the direction of travel, so a block that is its own
+                // neighbour still matches the right halo
+                MPI_Irecv(recv, count, type, neighbours[d], OPPOSITE[d], cart, &requests[2 * d]);
+                MPI_Isend(send, count, type, neighbours[d], d, cart, &requests[2 * d + 1]);
+            }
+        }
+
+        void calculate(int row_begin, int row_end, int col_begin, int col_end) {
+            int back = 1 - front;
+            for (int i = row_begin; i < row_end; i++) {
+                const uint8_t* up = cell(front, i - 1, 0);
+                const uint8_t* mid = cell(front, i, 0);
+                const uint8_t* down = cell(front, i + 1, 0);
+                uint8_t* out = cell(back, i, 0);
+                for (int j = col_begin; j < col_end; j++) {
+                    int live_neighbours = up[j - 1] + up[j] + up[j + 1]
+                        + mid[j - 1] + mid[j + 1]
+                        + down[j - 1] + down[j] + down[j + 1];
+                    out[j] = RULE[mid[j]][live_neighbours];
+                }
+            }
+        }
+
+        MPI_Comm cart;
+        MPI_Datatype column_type;
+        int rank;
+        int coords[2];
+        int proc_rows, proc_cols;
+        int neighbours[DIRECTIONS];
+        int global_rows, global_cols;
+        int row0, col0, rows, cols, stride;
+        bool wrap;
+        std::vector<uint8_t> cells[2];
+        int front = 0;
+    };
+
+    std::vector<std::vector<int>> serial_generation(std::vector<std::vector<int>> matrix, int generations, bool wrap) {
+        int r = (int)matrix.size(), c = (int)matrix[0].size();
+        for (int g = 0; g < generations; g++) {
+            std::vector<std::vector<int>> next(r, std::vector<int>(c));
+            for (int i = 0; i < r; i++) {
+                for (int j = 0; j < c; j++) {
+                    int live_neighbours = 0;
+                    for (int di = -1; di <= 1; di++) {
+                        for (int dj = -1; dj <= 1; dj++) {
+                            if (di == 0 && dj == 0)
+                                continue;
+                            int ni = i + di, nj = j + dj;
+                            if (wrap) {
+                                ni = (ni + r) % r;
+                                nj = (nj + c) % c;
+                            }
+                            else if (ni < 0 || ni >= r || nj < 0 || nj >= c) {
+                                continue;
+                            }
+                            live_neighbours += matrix[ni][nj];
+                        }
+                    }
+                    next[i][j] = RULE[matrix[i][j]][live_neighbours];
+                }
+            }
+            matrix.swap(next);
+        }
+        return matrix;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rows = 512, cols = 512, generations = 100;
+    bool wrap = true;
+    double prob = 0.25;
+    uint64_t seed = 1;
+    bool verify = false;
+    if (argc >= 3) rows = std::stoi(argv[1]), cols = std::stoi(argv[2]);
+    if (argc >= 4) generations = std::stoi(argv[3]);
+    if (argc >= 5) wrap = std::string(argv[4]) != "finite";
+    if (argc >= 6) prob = std::stod(argv[5]);
+    if (argc >= 7) seed = std::stoull(argv[6]);
+    if (argc >= 8) verify = std::string(argv[7]) == "verify";
+
+    int result = 0;
+    {
+        distributed_life::Subdomain domain(rows, cols, wrap, MPI_COMM_WORLD);
+        int rank = domain.get_rank();
+        domain.seed(prob, seed);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t_start = MPI_Wtime();
+        for (int g = 0; g < generations; g++)
+            domain.step();
+        MPI_Barrier(MPI_COMM_WORLD);
+        double duration = (MPI_Wtime() - t_start) * 1000;
+
+        std::vector<std::vector<int>> grid = domain.gather(0);
+        if (rank == 0) {
+            long long population = 0;
+            for (const auto& row : grid)
+                for (int cell : row)
+                    population += cell;
+            std::cout << "Generation " << generations << " population: " << population << "\n";
+            std::cout << "Game of Life completed in " << duration << " miliseconds.\n";
+            if (verify) {
+                std::vector<std::vector<int>> start(rows, std::vector<int>(cols));
+                for (int i = 0; i < rows; i++)
+                    for (int j = 0; j < cols; j++)
+                        start[i][j] = distributed_life::start_value(i, j, prob, seed);
+                bool same = distributed_life::serial_generation(start, generations, wrap) == grid;
+                std::cout << (same ? "Verified against serial run.\n" : "MISMATCH against serial run.\n");
+                result = same ? 0 : 1;
+            }
+        }
+        MPI_Bcast(&result, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    }
+
+    MPI_Finalize();
+    return result;
+}
\ No newline at end of file
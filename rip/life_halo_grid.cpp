@@ -0,0 +1,89 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <cstring>
+
+namespace halo_grid {
+    HaloGrid::HaloGrid(int rows, int cols)
+        : rows(rows), cols(cols), stride(cols + 2), cells((size_t)(rows + 2) * (cols + 2), 0) {
+    }
+
+    void HaloGrid::fill_halo(bool wrap) {
+        uint8_t* top = cells.data();
+        uint8_t* bottom = cells.data() + (size_t)(rows + 1) * stride;
+        if (!wrap) {
+            std::memset(top, 0, stride);
+            std::memset(bottom, 0, stride);
+            for (int i = 0; i < rows; i++) {
+                row(i)[-1] = 0;
+                row(i)[cols] = 0;
+            }
+            return;
+        }
+        // columns first, so the corners come along with the row copies below
+        for (int i = 0; i < rows; i++) {
+            row(i)[-1] = row(i)[cols - 1];
+            row(i)[cols] = row(i)[0];
+        }
+        std::memcpy(top, row(rows - 1) - 1, stride);
+        std::memcpy(bottom, row(0) - 1, stride);
+    }
+
+    void load_matrix(HaloGrid& grid, const std::vector<std::vector<int>>& matrix) {
+        for (int i = 0; i < grid.rows; i++) {
+            for (int j = 0; j < grid.cols; j++) {
+                grid.at(i, j) = matrix[i][j] ? 1 : 0;
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> to_matrix(const HaloGrid& grid) {
+        std::vector<std::vector<int>> matrix(grid.rows, std::vector<int>(grid.cols));
+        for (int i = 0; i < grid.rows; i++) {
+            for (int j = 0; j < grid.cols; j++) {
+                matrix[i][j] = grid.at(i, j);
+            }
+        }
+        return matrix;
+    }
+
+    void calculate_next_generation(HaloGrid& current, HaloGrid& next, bool wrap) {
+        current.fill_halo(wrap);
+        int rows = current.rows;
+        int cols = current.cols;
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < rows; i++) {
+            const uint8_t* up = current.row(i - 1);
+            const uint8_t* mid = current.row(i);
+            const uint8_t* down = current.row(i + 1);
+            uint8_t* out = next.row(i);
+            for (int j = 0; j < cols; j++) {
+                int live_neighbours = up[j - 1] + up[j] + up[j + 1]
+                    + mid[j - 1] + mid[j + 1]
+                    + down[j - 1] + down[j] + down[j + 1];
+                out[j] = CONWAY_RULE[mid[j]][live_neighbours];
+            }
+        }
+    }
+
+    DoubleBuffer::DoubleBuffer(int rows, int cols)
+        : buffers{ HaloGrid(rows, cols), HaloGrid(rows, cols) } {
+    }
+
+    void DoubleBuffer::step(bool wrap) {
+        calculate_next_generation(buffers[front], buffers[1 - front], wrap);
+        front = 1 - front;
+    }
+
+    //int main()
+    //{
+    //    DoubleBuffer generations(multi_core::M, multi_core::N);
+    //    load_matrix(generations.current(), multi_core::generate_start_values());
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    for (int iteration = 0; iteration < multi_core::NUMBER_OF_ITERATIONS; iteration++)
+    //        generations.step(false);
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
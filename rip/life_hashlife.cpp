@@ -0,0 +1,356 @@
+#include "game_of_life.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace hash_life {
+    const uint32_t NONE = 0xFFFFFFFFu;
+
+    // Thrown out of join() when a jump outgrows max_nodes; advance_pow2()
+    // catches it, collects and retries the jump in two halves.
+    struct JumpTooLarge {};
+
+    static inline size_t hash_children(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+        uint64_t h = nw;
+        h = h * 0x9E3779B97F4A7C15ULL + ne;
+        h = h * 0x9E3779B97F4A7C15ULL + sw;
+        h = h * 0x9E3779B97F4A7C15ULL + se;
+        return (size_t)(h ^ (h >> 29));
+    }
+
+    // Capped below NONE so a jump is always cut short before the indices run out.
+    Universe::Universe(size_t max_nodes) : max_nodes(std::min<size_t>(max_nodes, NONE - 1)) {
+        // nodes 0 and 1 are the dead and live cells, they are never hashed or freed
+        nodes.push_back({ NONE, NONE, NONE, NONE, NONE, NONE, 0, 0, false });
+        nodes.push_back({ NONE, NONE, NONE, NONE, NONE, NONE, 1, 0, false });
+        buckets.assign(1 << 16, NONE);
+        empty_nodes.push_back(leaf(0));
+        root = empty(3);
+    }
+
+    uint32_t Universe::join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+        size_t bucket = hash_children(nw, ne, sw, se) & (buckets.size() - 1);
+        for (uint32_t n = buckets[bucket]; n != NONE; n = nodes[n].next) {
+            const Node& node = nodes[n];
+            if (node.nw == nw && node.ne == ne && node.sw == sw && node.se == se)
+                return n;
+        }
+        Node node;
+        node.nw = nw;
+        node.ne = ne;
+        node.sw = sw;
+        node.se = se;
+        node.next = buckets[bucket];
+        node.result = NONE;
+        node.population = nodes[nw].population + nodes[ne].population + nodes[sw].population + nodes[se].population;
+        node.level = nodes[nw].level + 1;
+        node.marked = false;
+        uint32_t n;
+        if (!free_nodes.empty()) {
+            n = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[n] = node;
+        }
+        else {
+            if (nodes.size() >= NONE)
+                throw std::runtime_error("hash_life: node indices exhausted");
+            n = (uint32_t)nodes.size();
+            nodes.push_back(node);
+        }
+        buckets[bucket] = n;
+        if (node_count() > buckets.size())
+            rehash(buckets.size() * 2);
+        // the new node is linked in, so unwinding here leaves the table whole
+        if (jumping && node_count() > max_nodes)
+            throw JumpTooLarge();
+        return n;
+    }
+
+    void Universe::rehash(size_t bucket_count) {
+        buckets.assign(bucket_count, NONE);
+        std::vector<bool> is_free(nodes.size(), false);
+        for (uint32_t n : free_nodes)
+            is_free[n] = true;
+        for (uint32_t n = 2; n < nodes.size(); n++) {
+            if (is_free[n])
+                continue;
+            Node& node = nodes[n];
+            size_t bucket = hash_children(node.nw, node.ne, node.sw, node.se) & (bucket_count - 1);
+            node.next = buckets[bucket];
+            buckets[bucket] = n;
+        }
+    }
+
+    uint32_t Universe::empty(int level) {
+        while ((int)empty_nodes.size() <= level) {
+            uint32_t e = empty_nodes.back();
+            empty_nodes.push_back(join(e, e, e, e));
+        }
+        return empty_nodes[level];
+    }
+
+    uint32_t Universe::centre(uint32_t n) {
+        Node node = nodes[n];
+        return join(nodes[node.nw].se, nodes[node.ne].sw, nodes[node.sw].ne, nodes[node.se].nw);
+    }
+
+    // Level 2 (4x4) to level 1 (2x2) one generation ahead, cell by cell.
+    uint32_t Universe::step_base(uint32_t n) {
+        int cells[4][4];
+        const uint32_t quadrants[2][2] = { { nodes[n].nw, nodes[n].ne }, { nodes[n].sw, nodes[n].se } };
+        for (int qy = 0; qy < 2; qy++) {
+            for (int qx = 0; qx < 2; qx++) {
+                const Node& q = nodes[quadrants[qy][qx]];
+                cells[qy * 2][qx * 2] = (int)nodes[q.nw].population;
+                cells[qy * 2][qx * 2 + 1] = (int)nodes[q.ne].population;
+                cells[qy * 2 + 1][qx * 2] = (int)nodes[q.sw].population;
+                cells[qy * 2 + 1][qx * 2 + 1] = (int)nodes[q.se].population;
+            }
+        }
+        uint32_t out[2][2];
+        for (int y = 1; y < 3; y++) {
+            for (int x = 1; x < 3; x++) {
+                int live_neighbours = 0;
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++)
+                        live_neighbours += cells[y + dy][x + dx];
+                live_neighbours -= cells[y][x];
+                out[y - 1][x - 1] = leaf(live_neighbours == 3 || (cells[y][x] && live_neighbours == 2));
+            }
+        }
+        return join(out[0][0], out[0][1], out[1][0], out[1][1]);
+    }
+
+    // Centre half of n advanced by 2^step_log2 generations, or by 2^(level-2) when
+    // n is too small for a full step. Nodes at or below level step_log2 + 2 take
+    // the full-speed path, larger ones only advance in the second phase.
+    uint32_t Universe::next(uint32_t n) {
+        if (nodes[n].result != NONE)
+            return nodes[n].result;
+        int level = nodes[n].level;
+        uint32_t result;
+        if (nodes[n].population == 0) {
+            result = empty(level - 1);
+        }
+        else if (level == 2) {
+            result = step_base(n);
+        }
+        else {
+            bool full_speed = step_log2 >= level - 2;
+            Node node = nodes[n];
+            Node nw = nodes[node.nw], ne = nodes[node.ne], sw = nodes[node.sw], se = nodes[node.se];
+            uint32_t sub[3][3] = {
+                { node.nw, join(nw.ne, ne.nw, nw.se, ne.sw), node.ne },
+                { join(nw.sw, nw.se, sw.nw, sw.ne), join(nw.se, ne.sw, sw.ne, se.nw), join(ne.sw, ne.se, se.nw, se.ne) },
+                { node.sw, join(sw.ne, se.nw, sw.se, se.sw), node.se },
+            };
+            for (int y = 0; y < 3; y++)
+                for (int x = 0; x < 3; x++)
+                    sub[y][x] = full_speed ? next(sub[y][x]) : centre(sub[y][x]);
+            uint32_t q_nw = next(join(sub[0][0], sub[0][1], sub[1][0], sub[1][1]));
+            uint32_t q_ne = next(join(sub[0][1], sub[0][2], sub[1][1], sub[1][2]));
+            uint32_t q_sw = next(join(sub[1][0], sub[1][1], sub[2][0], sub[2][1]));
+            uint32_t q_se = next(join(sub[1][1], sub[1][2], sub[2][1], sub[2][2]));
+            result = join(q_nw, q_ne, q_sw, q_se);
+        }
+        nodes[n].result = result;
+        return result;
+    }
+
+    uint32_t Universe::build(const std::vector<std::vector<int>>& matrix, int level, int64_t x, int64_t y) {
+        int64_t rows = (int64_t)matrix.size();
+        int64_t cols = rows == 0 ? 0 : (int64_t)matrix[0].size();
+        int64_t size = (int64_t)1 << level;
+        if (x >= cols || y >= rows || x + size <= 0 || y + size <= 0)
+            return empty(level);
+        if (level == 0)
+            return leaf(x >= 0 && y >= 0 && matrix[y][x] ? 1 : 0);
+        int64_t half = size / 2;
+        uint32_t nw = build(matrix, level - 1, x, y);
+        uint32_t ne = build(matrix, level - 1, x + half, y);
+        uint32_t sw = build(matrix, level - 1, x, y + half);
+        uint32_t se = build(matrix, level - 1, x + half, y + half);
+        return join(nw, ne, sw, se);
+    }
+
+    void Universe::load_matrix(const std::vector<std::vector<int>>& matrix, int64_t x0, int64_t y0) {
+        int64_t rows = (int64_t)matrix.size();
+        int64_t cols = rows == 0 ? 0 : (int64_t)matrix[0].size();
+        int level = 3;
+        while (((int64_t)1 << level) < std::max(rows, cols))
+            level++;
+        root = build(matrix, level, 0, 0);
+        origin_x = x0;
+        origin_y = y0;
+        generation_count = 0;
+    }
+
+    void Universe::export_node(uint32_t n, int64_t x, int64_t y, int64_t x0, int64_t y0,
+        std::vector<std::vector<int>>& matrix) const {
+        const Node& node = nodes[n];
+        int64_t rows = (int64_t)matrix.size();
+        int64_t cols = rows == 0 ? 0 : (int64_t)matrix[0].size();
+        int64_t size = (int64_t)1 << node.level;
+        if (node.population == 0 || x >= x0 + cols || y >= y0 + rows || x + size <= x0 || y + size <= y0)
+            return;
+        if (node.level == 0) {
+            matrix[y - y0][x - x0] = 1;
+            return;
+        }
+        int64_t half = size / 2;
+        export_node(node.nw, x, y, x0, y0, matrix);
+        export_node(node.ne, x + half, y, x0, y0, matrix);
+        export_node(node.sw, x, y + half, x0, y0, matrix);
+        export_node(node.se, x + half, y + half, x0, y0, matrix);
+    }
+
+    std::vector<std::vector<int>> Universe::to_matrix(int64_t x0, int64_t y0, int rows, int cols) const {
+        std::vector<std::vector<int>> matrix(rows, std::vector<int>(cols));
+        export_node(root, origin_x, origin_y, x0, y0, matrix);
+        return matrix;
+    }
+
+    int Universe::get(int64_t x, int64_t y) const {
+        uint32_t n = root;
+        int64_t nx = origin_x, ny = origin_y;
+        int64_t size = (int64_t)1 << nodes[n].level;
+        if (x < nx || y < ny || x >= nx + size || y >= ny + size)
+            return 0;
+        while (nodes[n].level > 0 && nodes[n].population > 0) {
+            size /= 2;
+            bool east = x >= nx + size, south = y >= ny + size;
+            const Node& node = nodes[n];
+            n = south ? (east ? node.se : node.sw) : (east ? node.ne : node.nw);
+            nx += east ? size : 0;
+            ny += south ? size : 0;
+        }
+        return (int)nodes[n].population;
+    }
+
+    uint64_t Universe::population() const {
+        return nodes[root].population;
+    }
+
+    // True when every live cell sits in the centre quarter of the root, so a jump
+    // of up to 2^(level-3) generations cannot reach the edge of the result.
+    bool Universe::fits_centre() const {
+        const Node& r = nodes[root];
+        if (r.level < 3)
+            return false;
+        uint64_t inner = nodes[nodes[nodes[r.nw].se].se].population + nodes[nodes[nodes[r.ne].sw].sw].population +
+            nodes[nodes[nodes[r.sw].ne].ne].population + nodes[nodes[nodes[r.se].nw].nw].population;
+        return inner == r.population;
+    }
+
+    void Universe::expand() {
+        Node r = nodes[root];
+        uint32_t e = empty(r.level - 1);
+        uint32_t nw = join(e, e, e, r.nw);
+        uint32_t ne = join(e, e, r.ne, e);
+        uint32_t sw = join(e, r.sw, e, e);
+        uint32_t se = join(r.se, e, e, e);
+        root = join(nw, ne, sw, se);
+        int64_t shift = (int64_t)1 << (r.level - 1);
+        origin_x -= shift;
+        origin_y -= shift;
+    }
+
+    void Universe::set_step(int log2_generations) {
+        if (step_log2 == log2_generations)
+            return;
+        step_log2 = log2_generations;
+        for (Node& node : nodes)
+            node.result = NONE;
+    }
+
+    void Universe::mark(uint32_t n) {
+        while (n != NONE && !nodes[n].marked) {
+            nodes[n].marked = true;
+            if (nodes[n].level == 0)
+                return;
+            mark(nodes[n].nw);
+            mark(nodes[n].ne);
+            mark(nodes[n].sw);
+            n = nodes[n].se;
+        }
+    }
+
+    // Keeps the current pattern and the empty nodes, drops every cached result
+    // and recycles everything else.
+    void Universe::collect_garbage() {
+        for (Node& node : nodes) {
+            node.marked = false;
+            node.result = NONE;
+        }
+        mark(root);
+        for (uint32_t e : empty_nodes)
+            mark(e);
+        free_nodes.clear();
+        for (uint32_t n = 2; n < nodes.size(); n++) {
+            if (!nodes[n].marked)
+                free_nodes.push_back(n);
+        }
+        rehash(buckets.size());
+    }
+
+    // Collecting before the jump leaves it half of max_nodes to grow into. A
+    // jump that still outgrows max_nodes is abandoned (root is only replaced
+    // once next() returns), and after a collection it runs as two jumps of
+    // half the length, each of which may split again. Only a single
+    // generation that does not fit is an error.
+    void Universe::advance_pow2(int log2_generations) {
+        if (node_count() > max_nodes / 2)
+            collect_garbage();
+        while (nodes[root].level < log2_generations + 3 || !fits_centre())
+            expand();
+        set_step(log2_generations);
+        int64_t shift = (int64_t)1 << (nodes[root].level - 2);
+        uint32_t result;
+        try {
+            jumping = true;
+            result = next(root);
+            jumping = false;
+        }
+        catch (const JumpTooLarge&) {
+            jumping = false;
+            collect_garbage();
+            if (log2_generations == 0)
+                throw std::runtime_error("hash_life: one generation needs more than max_nodes nodes");
+            advance_pow2(log2_generations - 1);
+            advance_pow2(log2_generations - 1);
+            return;
+        }
+        root = result;
+        origin_x += shift;
+        origin_y += shift;
+        generation_count += (uint64_t)1 << log2_generations;
+    }
+
+    void Universe::advance(uint64_t generations) {
+        for (int bit = 0; generations != 0; bit++, generations >>= 1) {
+            if (generations & 1)
+                advance_pow2(bit);
+        }
+    }
+
+    std::vector<std::vector<int>> calculate_generation(const std::vector<std::vector<int>>& matrix,
+        uint64_t generations) {
+        Universe universe;
+        universe.load_matrix(matrix);
+        universe.advance(generations);
+        int rows = (int)matrix.size();
+        return universe.to_matrix(0, 0, rows, rows == 0 ? 0 : (int)matrix[0].size());
+    }
+
+    //int main()
+    //{
+    //    Universe universe;
+    //    universe.load_matrix(multi_core::generate_start_values());
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    universe.advance(1000000000000ULL);
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Population: " << universe.population() << " nodes: " << universe.node_count() << std::endl;
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
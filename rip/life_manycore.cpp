@@ -0,0 +1,232 @@
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#include "game_of_life.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace many_core_life {
+    // One work-group computes a tile. It first stages the tile plus a one-cell
+    // halo in __local memory (each work-item loads one or more cells), so every
+    // cell is read from global memory about once instead of nine times.
+    const char* kernelSource = R"(
+__kernel void life(__global const uchar* current, __global uchar* next,
+                   const int rows, const int cols, const int wrap,
+                   __local uchar* tile) {
+    const int lx = get_local_id(0);
+    const int ly = get_local_id(1);
+    const int tw = get_local_size(0);
+    const int th = get_local_size(1);
+    const int col0 = get_group_id(0) * tw;
+    const int row0 = get_group_id(1) * th;
+    const int width = tw + 2;
+    const int cells = width * (th + 2);
+
+    for (int idx = ly * tw + lx; idx < cells; idx += tw * th) {
+        int r = row0 - 1 + idx / width;
+        int c = col0 - 1 + idx % width;
+        uchar value = 0;
+        if (wrap) {
+            r = (r + rows) % rows;
+            c = (c + cols) % cols;
+            value = current[r * cols + c];
+        }
+        else if (r >= 0 && r < rows && c >= 0 && c < cols) {
+            value = current[r * cols + c];
+        }
+        tile[idx] = value;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    const int i = row0 + ly;
+    const int j = col0 + lx;
+    if (i >= rows || j >= cols)
+        return;
+    const int t = (ly + 1) * width + lx + 1;
+    int live_neighbours = tile[t - width - 1] + tile[t - width] + tile[t - width + 1]
+        + tile[t - 1] + tile[t + 1]
+        + tile[t + width - 1] + tile[t + width] + tile[t + width + 1];
+    uchar cell = tile[t];
+    next[i * cols + j] = (live_neighbours == 3 || (cell && live_neighbours == 2)) ? 1 : 0;
+}
+)";
+
+    struct OpenCLLife::Handles {
+        cl_device_id device = NULL;
+        cl_context context = NULL;
+        cl_command_queue queue = NULL;
+        cl_program program = NULL;
+        cl_kernel kernel = NULL;
+        cl_mem buffers[2] = { NULL, NULL };
+        size_t local_size[2] = { 16, 16 };
+    };
+
+    static void check(cl_int err, const char* what) {
+        if (err != CL_SUCCESS)
+            throw std::runtime_error(std::string(what) + " failed with OpenCL error " + std::to_string(err));
+    }
+
+    // First device of the requested type on any platform.
+    static bool find_device(cl_device_type type, cl_device_id& device) {
+        cl_uint platform_count = 0;
+        if (clGetPlatformIDs(0, NULL, &platform_count) != CL_SUCCESS || platform_count == 0)
+            return false;
+        std::vector<cl_platform_id> platforms(platform_count);
+        clGetPlatformIDs(platform_count, platforms.data(), NULL);
+        for (cl_platform_id platform : platforms) {
+            if (clGetDeviceIDs(platform, type, 1, &device, NULL) == CL_SUCCESS)
+                return true;
+        }
+        return false;
+    }
+
+    // Shrinks the 16 x 16 tile until the work-group fits the device and the
+    // compiled kernel, whose limit can be lower than the device's (the __local
+    // tile and register use count against it), and each side fits the
+    // work-item limit of its dimension. The larger side is halved first so
+    // the tile stays close to square and the halo stays small.
+    void OpenCLLife::fit_local_size() {
+        size_t max_group = 0;
+        check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_group), &max_group, NULL),
+            "clGetDeviceInfo");
+        size_t kernel_group = 0;
+        check(clGetKernelWorkGroupInfo(cl->kernel, cl->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernel_group),
+            &kernel_group, NULL), "clGetKernelWorkGroupInfo");
+        cl_uint dimensions = 0;
+        check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(dimensions), &dimensions, NULL),
+            "clGetDeviceInfo");
+        std::vector<size_t> max_items(std::max<cl_uint>(dimensions, 2), 1);
+        check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_ITEM_SIZES, dimensions * sizeof(size_t), max_items.data(),
+            NULL), "clGetDeviceInfo");
+
+        size_t limit = std::min(max_group, kernel_group);
+        size_t* local = cl->local_size;
+        while (local[0] > max_items[0] || local[1] > max_items[1] || local[0] * local[1] > limit) {
+            int side = local[1] > max_items[1] || (local[0] <= max_items[0] && local[1] > local[0]) ? 1 : 0;
+            if (local[side] == 1)
+                throw std::runtime_error("OpenCL device cannot run a 1 x 1 work-group");
+            local[side] /= 2;
+        }
+    }
+
+    OpenCLLife::OpenCLLife(int rows, int cols, bool wrap) : cl(new Handles()), rows(rows), cols(cols), wrap(wrap) {
+        try {
+            if (!find_device(CL_DEVICE_TYPE_GPU, cl->device) && !find_device(CL_DEVICE_TYPE_CPU, cl->device))
+                throw std::runtime_error("no OpenCL GPU or CPU device found");
+
+            char name[256] = { 0 };
+            clGetDeviceInfo(cl->device, CL_DEVICE_NAME, sizeof(name) - 1, name, NULL);
+            device = name;
+
+            cl_int err;
+            cl->context = clCreateContext(NULL, 1, &cl->device, NULL, NULL, &err);
+            check(err, "clCreateContext");
+            cl->queue = clCreateCommandQueue(cl->context, cl->device, 0, &err);
+            check(err, "clCreateCommandQueue");
+            cl->program = clCreateProgramWithSource(cl->context, 1, &kernelSource, NULL, &err);
+            check(err, "clCreateProgramWithSource");
+            err = clBuildProgram(cl->program, 1, &cl->device, NULL, NULL, NULL);
+            if (err != CL_SUCCESS) {
+                size_t log_size = 0;
+                clGetProgramBuildInfo(cl->program, cl->device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+                std::string log(log_size, '\0');
+                clGetProgramBuildInfo(cl->program, cl->device, CL_PROGRAM_BUILD_LOG, log_size, &log[0], NULL);
+                throw std::runtime_error("clBuildProgram failed: " + log);
+            }
+            cl->kernel = clCreateKernel(cl->program, "life", &err);
+            check(err, "clCreateKernel");
+            fit_local_size();
+
+            size_t bytes = (size_t)rows * cols;
+            for (int b = 0; b < 2; b++) {
+                cl->buffers[b] = clCreateBuffer(cl->context, CL_MEM_READ_WRITE, bytes, NULL, &err);
+                check(err, "clCreateBuffer");
+            }
+            cl_int wrap_arg = wrap ? 1 : 0;
+            size_t tile_bytes = (cl->local_size[0] + 2) * (cl->local_size[1] + 2);
+            check(clSetKernelArg(cl->kernel, 2, sizeof(int), &rows), "clSetKernelArg");
+            check(clSetKernelArg(cl->kernel, 3, sizeof(int), &cols), "clSetKernelArg");
+            check(clSetKernelArg(cl->kernel, 4, sizeof(cl_int), &wrap_arg), "clSetKernelArg");
+            check(clSetKernelArg(cl->kernel, 5, tile_bytes, NULL), "clSetKernelArg");
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    OpenCLLife::~OpenCLLife() {
+        release();
+    }
+
+    void OpenCLLife::release() {
+        if (cl == NULL)
+            return;
+        if (cl->queue)
+            clFinish(cl->queue);
+        for (cl_mem buffer : cl->buffers)
+            if (buffer)
+                clReleaseMemObject(buffer);
+        if (cl->kernel)
+            clReleaseKernel(cl->kernel);
+        if (cl->program)
+            clReleaseProgram(cl->program);
+        if (cl->queue)
+            clReleaseCommandQueue(cl->queue);
+        if (cl->context)
+            clReleaseContext(cl->context);
+        delete cl;
+        cl = NULL;
+    }
+
+    void OpenCLLife::load_matrix(const std::vector<std::vector<int>>& matrix) {
+        std::vector<uint8_t> cells((size_t)rows * cols);
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                cells[(size_t)i * cols + j] = matrix[i][j] ? 1 : 0;
+        front = 0;
+        check(clEnqueueWriteBuffer(cl->queue, cl->buffers[front], CL_TRUE, 0, cells.size(), cells.data(), 0, NULL, NULL),
+            "clEnqueueWriteBuffer");
+    }
+
+    void OpenCLLife::step(int generations) {
+        size_t global_size[2] = {
+            (cols + cl->local_size[0] - 1) / cl->local_size[0] * cl->local_size[0],
+            (rows + cl->local_size[1] - 1) / cl->local_size[1] * cl->local_size[1],
+        };
+        for (int g = 0; g < generations; g++) {
+            // arguments are captured at enqueue time, so swapping them between
+            // enqueues chains the generations without waiting
+            check(clSetKernelArg(cl->kernel, 0, sizeof(cl_mem), &cl->buffers[front]), "clSetKernelArg");
+            check(clSetKernelArg(cl->kernel, 1, sizeof(cl_mem), &cl->buffers[1 - front]), "clSetKernelArg");
+            check(clEnqueueNDRangeKernel(cl->queue, cl->kernel, 2, NULL, global_size, cl->local_size, 0, NULL, NULL),
+                "clEnqueueNDRangeKernel");
+            front = 1 - front;
+        }
+        check(clFlush(cl->queue), "clFlush");
+    }
+
+    std::vector<std::vector<int>> OpenCLLife::snapshot() {
+        std::vector<uint8_t> cells((size_t)rows * cols);
+        check(clEnqueueReadBuffer(cl->queue, cl->buffers[front], CL_TRUE, 0, cells.size(), cells.data(), 0, NULL, NULL),
+            "clEnqueueReadBuffer");
+        std::vector<std::vector<int>> matrix(rows, std::vector<int>(cols));
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                matrix[i][j] = cells[(size_t)i * cols + j];
+        return matrix;
+    }
+
+    //int main()
+    //{
+    //    OpenCLLife life(multi_core::M, multi_core::N, false);
+    //    life.load_matrix(multi_core::generate_start_values());
+    //    std::cout << "Device: " << life.device_name() << std::endl;
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    life.step(multi_core::NUMBER_OF_ITERATIONS);
+    //    std::vector<std::vector<int>> result = life.snapshot();
+    //    auto end = std::chrono::high_resolution_clock::now();
+    //    std::chrono::duration<double, std::milli> duration = end - start;
+    //    std::cout << "Execution time: " << duration.count() << " ms\n";
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace numa_life {
+    // "0-3,8-11" -> 0 1 2 3 8 9 10 11
+    static std::vector<int> parse_cpu_list(const char* text) {
+        std::vector<int> cpus;
+        const char* p = text;
+        while (*p) {
+            char* end;
+            long first = std::strtol(p, &end, 10);
+            if (end == p)
+                break;
+            long last = first;
+            p = end;
+            if (*p == '-') {
+                last = std::strtol(p + 1, &end, 10);
+                p = end;
+            }
+            for (long cpu = first; cpu <= last; cpu++)
+                cpus.push_back((int)cpu);
+            if (*p == ',')
+                p++;
+        }
+        return cpus;
+    }
+
+#ifndef _WIN32
+    static std::string read_line(const char* path) {
+        char line[4096] = { 0 };
+        FILE* file = std::fopen(path, "r");
+        if (!file)
+            return "";
+        if (!std::fgets(line, sizeof(line), file))
+            line[0] = 0;
+        std::fclose(file);
+        return line;
+    }
+#endif
+
+    Topology detect_topology() {
+        Topology topology;
+#ifdef _WIN32
+        ULONG highest = 0;
+        if (GetNumaHighestNodeNumber(&highest)) {
+            for (USHORT node = 0; node <= highest; node++) {
+                GROUP_AFFINITY affinity;
+                if (!GetNumaNodeProcessorMaskEx(node, &affinity) || affinity.Mask == 0)
+                    continue;
+                std::vector<int> cpus;
+                for (int bit = 0; bit < 64; bit++)
+                    if ((affinity.Mask >> bit) & 1)
+                        cpus.push_back(affinity.Group * 64 + bit);
+                topology.node_cpus.push_back(cpus);
+            }
+        }
+#else
+        // node numbers need not be contiguous, "online" lists the ones present
+        for (int node : parse_cpu_list(read_line("/sys/devices/system/node/online").c_str())) {
+            char path[64];
+            std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+            std::vector<int> cpus = parse_cpu_list(read_line(path).c_str());
+            if (!cpus.empty())
+                topology.node_cpus.push_back(cpus);
+        }
+#endif
+        if (topology.node_cpus.empty()) {
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < omp_get_num_procs(); cpu++)
+                cpus.push_back(cpu);
+            topology.node_cpus.push_back(cpus);
+        }
+        return topology;
+    }
+
+    static bool pin_current_thread(int cpu) {
+#ifdef _WIN32
+        GROUP_AFFINITY affinity = {};
+        affinity.Group = (WORD)(cpu / 64);
+        affinity.Mask = (KAFFINITY)1 << (cpu % 64);
+        return SetThreadGroupAffinity(GetCurrentThread(), &affinity, NULL) != 0;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+    }
+
+    static thread_local int pinned_cpu = -1;
+
+    // The OpenMP runtime normally keeps the same thread behind each thread
+    // number, but nothing guarantees it; re-pin only when the OS thread changed.
+    static void ensure_pinned(int cpu) {
+        if (pinned_cpu != cpu && pin_current_thread(cpu))
+            pinned_cpu = cpu;
+    }
+
+    // Thread 0 of every region is the caller, which gets pinned to band 0's
+    // CPU like the others. This puts its own affinity back when the region is
+    // over, so the caller and the threads it creates later are not left on
+    // one CPU.
+    class CallerAffinity {
+    public:
+        CallerAffinity() {
+#ifdef _WIN32
+            saved = GetThreadGroupAffinity(GetCurrentThread(), &mask) != 0;
+#else
+            saved = pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#endif
+        }
+        ~CallerAffinity() {
+            if (!saved)
+                return;
+#ifdef _WIN32
+            SetThreadGroupAffinity(GetCurrentThread(), &mask, NULL);
+#else
+            pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+#endif
+            pinned_cpu = -1;
+        }
+        CallerAffinity(const CallerAffinity&) = delete;
+        CallerAffinity& operator=(const CallerAffinity&) = delete;
+
+    private:
+#ifdef _WIN32
+        GROUP_AFFINITY mask;
+#else
+        cpu_set_t mask;
+#endif
+        bool saved;
+    };
+
+    // Every region indexes bands by thread number and assumes one thread per
+    // band. A smaller team (nested inside another parallel region, or cut by
+    // OMP_DYNAMIC / OMP_THREAD_LIMIT) would leave bands unallocated or unstepped.
+    static void require_full_team(bool full_team) {
+        if (!full_team)
+            throw std::runtime_error("NumaLife: OpenMP gave fewer threads than bands");
+    }
+
+    NumaLife::NumaLife(int rows, int cols, int threads)
+        : rows(rows), cols(cols), words_per_row((cols + 63) / 64), topology(detect_topology()) {
+        int cpu_count = 0;
+        for (const auto& cpus : topology.node_cpus)
+            cpu_count += (int)cpus.size();
+        if (threads <= 0)
+            threads = cpu_count;
+        threads = std::max(1, std::min(threads, rows));
+
+        // Consecutive bands go to the same node, so only the rows where one
+        // node's bands meet the next node's cross the interconnect. Nodes get
+        // threads in proportion to their cores.
+        int cpus_before = 0;
+        int nodes = (int)topology.node_cpus.size();
+        for (int node = 0; node < nodes; node++) {
+            const std::vector<int>& cpus = topology.node_cpus[node];
+            cpus_before += (int)cpus.size();
+            int end = node + 1 == nodes ? threads : (int)((long long)threads * cpus_before / cpu_count);
+            for (int t = (int)bands.size(), first = t; t < end; t++) {
+                Band band;
+                band.node = node;
+                band.cpu = cpus[(t - first) % cpus.size()];
+                bands.push_back(band);
+            }
+        }
+
+        int base = rows / threads, remainder = rows % threads;
+        for (int t = 0, row = 0; t < threads; t++) {
+            bands[t].first_row = row;
+            bands[t].rows = base + (t < remainder ? 1 : 0);
+            row += bands[t].rows;
+        }
+
+        // every band is allocated and first-touched by the pinned thread that
+        // will compute it, so its pages land on that thread's node
+        CallerAffinity caller;
+        bool full_team = true;
+#pragma omp parallel num_threads(threads)
+        if (omp_get_num_threads() != threads) {
+#pragma omp master
+            full_team = false;
+        }
+        else {
+            Band& band = bands[omp_get_thread_num()];
+            ensure_pinned(band.cpu);
+            size_t words = (size_t)(band.rows + 2) * words_per_row;
+            band.cells[0].assign(words, 0);
+            band.cells[1].assign(words, 0);
+        }
+        require_full_team(full_team);
+    }
+
+    uint64_t* NumaLife::band_row(Band& band, int buffer, int i) {
+        return band.cells[buffer].data() + (size_t)(i + 1) * words_per_row;
+    }
+
+    const uint64_t* NumaLife::band_row(const Band& band, int buffer, int i) const {
+        return band.cells[buffer].data() + (size_t)(i + 1) * words_per_row;
+    }
+
+    void NumaLife::load_matrix(const std::vector<std::vector<int>>& matrix) {
+        front = 0;
+        int threads = (int)bands.size();
+        CallerAffinity caller;
+        bool full_team = true;
+#pragma omp parallel num_threads(threads)
+        if (omp_get_num_threads() != threads) {
+#pragma omp master
+            full_team = false;
+        }
+        else {
+            Band& band = bands[omp_get_thread_num()];
+            ensure_pinned(band.cpu);
+            std::fill(band.cells[0].begin(), band.cells[0].end(), 0);
+            for (int i = 0; i < band.rows; i++) {
+                uint64_t* row = band_row(band, 0, i);
+                for (int j = 0; j < cols; j++)
+                    if (matrix[band.first_row + i][j])
+                        row[j / 64] |= 1ULL << (j % 64);
+            }
+        }
+        require_full_team(full_team);
+    }
+
+    std::vector<std::vector<int>> NumaLife::to_matrix() const {
+        std::vector<std::vector<int>> matrix(rows, std::vector<int>(cols));
+        for (const Band& band : bands) {
+            for (int i = 0; i < band.rows; i++) {
+                const uint64_t* row = band_row(band, front, i);
+                for (int j = 0; j < cols; j++)
+                    matrix[band.first_row + i][j] = (int)((row[j / 64] >> (j % 64)) & 1);
+            }
+        }
+        return matrix;
+    }
+
+    void NumaLife::advance(int generations, bool wrap) {
+        int threads = (int)bands.size();
+        size_t row_bytes = (size_t)words_per_row * sizeof(uint64_t);
+        CallerAffinity caller;
+        bool full_team = true;
+#pragma omp parallel num_threads(threads)
+        if (omp_get_num_threads() != threads) {
+#pragma omp master
+            full_team = false;
+        }
+        else {
+            int t = omp_get_thread_num();
+            Band& band = bands[t];
+            ensure_pinned(band.cpu);
+            Band* above = t > 0 ? &bands[t - 1] : (wrap ? &bands[threads - 1] : NULL);
+            Band* below = t + 1 < threads ? &bands[t + 1] : (wrap ? &bands[0] : NULL);
+            int buffer = front;
+            for (int g = 0; g < generations; g++) {
+                // the neighbours' edge rows are the only remote reads; they are
+                // copied into the local halo rows once per generation
+                uint64_t* top_halo = band_row(band, buffer, -1);
+                uint64_t* bottom_halo = band_row(band, buffer, band.rows);
+                if (above)
+                    std::memcpy(top_halo, band_row(*above, buffer, above->rows - 1), row_bytes);
+                else
+                    std::memset(top_halo, 0, row_bytes);
+                if (below)
+                    std::memcpy(bottom_halo, band_row(*below, buffer, 0), row_bytes);
+                else
+                    std::memset(bottom_halo, 0, row_bytes);
+                for (int i = 0; i < band.rows; i++)
+                    bit_packed::calculate_next_row(band_row(band, buffer, i - 1), band_row(band, buffer, i),
+                        band_row(band, buffer, i + 1), band_row(band, 1 - buffer, i), cols, wrap);
+                buffer = 1 - buffer;
+                // nobody may start reading edge rows of generation g + 1 while a
+                // neighbour is still reading generation g's
+#pragma omp barrier
+            }
+        }
+        require_full_team(full_team);
+        if (generations > 0 && generations % 2 == 1)
+            front = 1 - front;
+    }
+
+    //int main()
+    //{
+    //    NumaLife life(multi_core::M, multi_core::N);
+    //    life.load_matrix(multi_core::generate_start_values());
+    //    for (int t = 0; t < life.thread_count(); t++)
+    //        std::cout << "thread " << t << ": node " << life.node_of_thread(t) << std::endl;
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    life.advance(multi_core::NUMBER_OF_ITERATIONS, true);
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
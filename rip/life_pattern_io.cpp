@@ -0,0 +1,557 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pattern_io {
+    // Below this a file is parsed by one thread, the split is not worth it.
+    const size_t MIN_CHUNK_BYTES = 64 * 1024;
+    const int LEAF_LEVEL = 3;
+    const int MAX_MACROCELL_LEVEL = 62;
+
+    // Read-only mapping of a whole file. An empty file maps to size 0.
+    class MappedFile {
+    public:
+        explicit MappedFile(const char* path) {
+#ifdef _WIN32
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                return;
+            LARGE_INTEGER length;
+            if (!GetFileSizeEx(file, &length))
+                return;
+            length_bytes = (size_t)length.QuadPart;
+            opened = true;
+            if (length_bytes == 0)
+                return;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping != NULL)
+                view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            opened = view != NULL;
+#else
+            fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat info;
+            if (fstat(fd, &info) != 0)
+                return;
+            length_bytes = (size_t)info.st_size;
+            opened = true;
+            if (length_bytes == 0)
+                return;
+            void* address = mmap(NULL, length_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                opened = false;
+                return;
+            }
+            view = (const char*)address;
+            madvise(address, length_bytes, MADV_WILLNEED);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (view)
+                UnmapViewOfFile(view);
+            if (mapping)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+#else
+            if (view)
+                munmap((void*)view, length_bytes);
+            if (fd >= 0)
+                close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool ok() const { return opened; }
+        const char* data() const { return view; }
+        size_t size() const { return length_bytes; }
+
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#else
+        int fd = -1;
+#endif
+        const char* view = NULL;
+        size_t length_bytes = 0;
+        bool opened = false;
+    };
+
+    struct Box {
+        int64_t min_x = INT64_MAX, min_y = INT64_MAX, max_x = INT64_MIN, max_y = INT64_MIN;
+
+        bool empty() const { return min_x > max_x; }
+        void add(int64_t x, int64_t y) {
+            min_x = std::min(min_x, x);
+            min_y = std::min(min_y, y);
+            max_x = std::max(max_x, x);
+            max_y = std::max(max_y, y);
+        }
+        void add(const Box& other, int64_t dx, int64_t dy) {
+            if (other.empty())
+                return;
+            add(other.min_x + dx, other.min_y + dy);
+            add(other.max_x + dx, other.max_y + dy);
+        }
+    };
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    static bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static const char* skip_line(const char* p, const char* end) {
+        if (p >= end)
+            return end;
+        const char* newline = (const char*)std::memchr(p, '\n', end - p);
+        return newline ? newline + 1 : end;
+    }
+
+    // Bounded replacement for strtoll, the mapping is not null terminated.
+    static bool parse_int(const char*& p, const char* end, int64_t& value) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        bool negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+'))
+            p++;
+        if (p == end || !is_digit(*p))
+            return false;
+        value = 0;
+        while (p < end && is_digit(*p)) {
+            if (value > (INT64_MAX - 9) / 10)
+                return false;
+            value = value * 10 + (*p++ - '0');
+        }
+        if (negative)
+            value = -value;
+        return true;
+    }
+
+    // Splits [begin, end) into about one chunk per MIN_CHUNK_BYTES (at most four
+    // per thread). Every boundary is moved forward to just after a character
+    // accepted by at_boundary, so no chunk starts inside a token.
+    template <typename Boundary>
+    static std::vector<const char*> split_chunks(const char* begin, const char* end, Boundary at_boundary) {
+        size_t size = end - begin;
+        size_t chunks = std::min(std::max(size / MIN_CHUNK_BYTES, (size_t)1), (size_t)omp_get_max_threads() * 4);
+        std::vector<const char*> bounds(1, begin);
+        for (size_t c = 1; c < chunks; c++) {
+            const char* p = std::max(begin + size * c / chunks, bounds.back());
+            while (p < end && p > begin && !at_boundary(p[-1]))
+                p++;
+            bounds.push_back(p);
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
+
+    static std::vector<const char*> split_lines(const char* begin, const char* end) {
+        return split_chunks(begin, end, [](char c) { return c == '\n'; });
+    }
+
+    // Sets cols [col, col + count) of a row. Chunks are decoded concurrently and
+    // neighbouring chunks can touch the same word, so every word is or-ed in
+    // atomically.
+    static void set_run(bit_packed::BitGrid& grid, int64_t row, int64_t col, int64_t count) {
+        if (row < 0 || row >= grid.rows || col >= grid.cols || count <= 0)
+            return;
+        int64_t end = std::min(col + count, (int64_t)grid.cols);
+        col = std::max(col, (int64_t)0);
+        uint64_t* cells = grid.row((int)row);
+        while (col < end) {
+            int bit = (int)(col % 64);
+            int64_t span = std::min((int64_t)(64 - bit), end - col);
+            uint64_t mask = (span == 64 ? ~0ULL : (1ULL << span) - 1) << bit;
+            uint64_t& word = cells[col / 64];
+#pragma omp atomic
+            word |= mask;
+            col += span;
+        }
+    }
+
+    static bool make_grid(const Box& box, bit_packed::BitGrid& grid) {
+        if (box.empty()) {
+            grid = bit_packed::BitGrid(0, 0);
+            return true;
+        }
+        int64_t rows = box.max_y - box.min_y + 1;
+        int64_t cols = box.max_x - box.min_x + 1;
+        if (rows <= 0 || cols <= 0 || rows >= INT_MAX || cols >= INT_MAX)
+            return false;
+        grid = bit_packed::BitGrid((int)rows, (int)cols);
+        return true;
+    }
+
+    // RLE: '#' comment lines, a header "x = <cols>, y = <rows>[, rule = ...]",
+    // then runs "<count><tag>" where b is dead, o (or any other letter) is alive,
+    // $ ends a row and ! ends the pattern. A chunk's end position depends on all
+    // earlier chunks, so parsing takes two passes: every chunk first measures how
+    // far it moves the cursor, a prefix scan turns that into each chunk's start,
+    // and then all chunks decode at the same time.
+    struct RleChunk {
+        int64_t rows = 0;        // rows advanced by '$'
+        int64_t col = 0;         // end column, relative unless ended_row
+        bool ended_row = false;
+        bool terminated = false; // contains '!'
+        int64_t start_row = 0;
+        int64_t start_col = 0;
+        bool live = true;        // false when an earlier chunk held the '!'
+    };
+
+    template <typename Emit>
+    static void walk_rle(const char* p, const char* end, RleChunk& chunk, Emit emit) {
+        int64_t count = 0;
+        int64_t row = chunk.start_row, col = chunk.start_col;
+        for (; p < end; p++) {
+            char c = *p;
+            if (is_digit(c)) {
+                count = std::min(count * 10 + (c - '0'), (int64_t)INT_MAX);
+                continue;
+            }
+            if (is_space(c))
+                continue;
+            int64_t n = count == 0 ? 1 : count;
+            count = 0;
+            if (c == '!') {
+                chunk.terminated = true;
+                break;
+            }
+            if (c == '$') {
+                row += n;
+                col = 0;
+                chunk.ended_row = true;
+            }
+            else if (c == 'b' || c == '.') {
+                col += n;
+            }
+            else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                emit(row, col, n);
+                col += n;
+            }
+        }
+        chunk.rows = row - chunk.start_row;
+        chunk.col = chunk.ended_row ? col : col - chunk.start_col;
+    }
+
+    static bool parse_rle(const char* begin, const char* end, bit_packed::BitGrid& grid) {
+        const char* p = begin;
+        while (p < end && (is_space(*p) || *p == '#'))
+            p = *p == '#' ? skip_line(p, end) : p + 1;
+        const char* header_end = skip_line(p, end);
+        int64_t cols = -1, rows = -1;
+        for (const char* q = p; q < header_end; q++) {
+            if ((*q == 'x' || *q == 'y') && (q == p || q[-1] == ' ' || q[-1] == ',')) {
+                const char* value = q + 1;
+                while (value < header_end && (*value == ' ' || *value == '='))
+                    value++;
+                int64_t parsed;
+                if (parse_int(value, header_end, parsed))
+                    (*q == 'x' ? cols : rows) = parsed;
+            }
+        }
+        if (cols < 0 || rows < 0 || cols >= INT_MAX || rows >= INT_MAX)
+            return false;
+        grid = bit_packed::BitGrid((int)rows, (int)cols);
+
+        std::vector<const char*> bounds = split_chunks(header_end, end,
+            [](char c) { return !is_digit(c) && !is_space(c); });
+        int chunk_count = (int)bounds.size() - 1;
+        std::vector<RleChunk> chunks(chunk_count);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++)
+            walk_rle(bounds[c], bounds[c + 1], chunks[c], [](int64_t, int64_t, int64_t) {});
+
+        for (int c = 1; c < chunk_count; c++) {
+            const RleChunk& prev = chunks[c - 1];
+            chunks[c].live = prev.live && !prev.terminated;
+            chunks[c].start_row = prev.start_row + prev.rows;
+            chunks[c].start_col = prev.ended_row ? prev.col : prev.start_col + prev.col;
+        }
+
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++) {
+            if (!chunks[c].live)
+                continue;
+            RleChunk chunk = chunks[c];
+            walk_rle(bounds[c], bounds[c + 1], chunk,
+                [&grid](int64_t row, int64_t col, int64_t n) { set_run(grid, row, col, n); });
+        }
+        return true;
+    }
+
+    // Life 1.06: "#Life 1.06", more '#' lines, then one "x y" pair per live cell.
+    // Chunks of lines are parsed in parallel into coordinate lists; the union of
+    // their bounding boxes sizes the grid and the cells are placed in parallel.
+    static bool parse_life106(const char* begin, const char* end, bit_packed::BitGrid& grid) {
+        std::vector<const char*> bounds = split_lines(begin, end);
+        int chunk_count = (int)bounds.size() - 1;
+        std::vector<std::vector<int64_t>> cells(chunk_count);
+        std::vector<Box> boxes(chunk_count);
+        std::vector<uint8_t> failed(chunk_count, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++) {
+            for (const char* p = bounds[c]; p < bounds[c + 1]; ) {
+                const char* line_end = skip_line(p, bounds[c + 1]);
+                const char* q = p;
+                while (q < line_end && is_space(*q))
+                    q++;
+                if (q < line_end && *q != '#') {
+                    int64_t x, y;
+                    if (!parse_int(q, line_end, x) || !parse_int(q, line_end, y)) {
+                        failed[c] = 1;
+                        break;
+                    }
+                    cells[c].push_back(x);
+                    cells[c].push_back(y);
+                    boxes[c].add(x, y);
+                }
+                p = line_end;
+            }
+        }
+        Box box;
+        for (int c = 0; c < chunk_count; c++) {
+            if (failed[c])
+                return false;
+            box.add(boxes[c], 0, 0);
+        }
+        if (!make_grid(box, grid))
+            return false;
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++) {
+            for (size_t k = 0; k < cells[c].size(); k += 2)
+                set_run(grid, cells[c][k + 1] - box.min_y, cells[c][k] - box.min_x, 1);
+        }
+        return true;
+    }
+
+    // Macrocell ([M2], Golly): after the '#' lines every line is a node, numbered
+    // from 1. Level 3 leaves are 8x8 pictures in '.', '*' and '$'; any other line
+    // is "level nw ne sw se" with 0 for an empty child. The last node is the root.
+    struct MacroNode {
+        int level = 0;
+        uint32_t child[4] = { 0, 0, 0, 0 };
+        uint64_t leaf = 0; // bit 8 * y + x
+        Box box;           // live cells, relative to the node's corner
+    };
+
+    static bool parse_macro_line(const char* p, const char* end, MacroNode& node) {
+        if (*p == '.' || *p == '*' || *p == '$') {
+            node.level = LEAF_LEVEL;
+            int x = 0, y = 0;
+            for (; p < end && !is_space(*p); p++) {
+                if (*p == '$') {
+                    y++;
+                    x = 0;
+                    continue;
+                }
+                if (x >= 8 || y >= 8)
+                    return false;
+                if (*p == '*')
+                    node.leaf |= 1ULL << (8 * y + x);
+                else if (*p != '.')
+                    return false;
+                x++;
+            }
+            return true;
+        }
+        int64_t value;
+        if (!parse_int(p, end, value) || value <= LEAF_LEVEL || value > MAX_MACROCELL_LEVEL)
+            return false;
+        node.level = (int)value;
+        for (int q = 0; q < 4; q++) {
+            if (!parse_int(p, end, value) || value < 0 || value > UINT32_MAX)
+                return false;
+            node.child[q] = (uint32_t)value;
+        }
+        return true;
+    }
+
+    static void render_macro(const std::vector<MacroNode>& nodes, uint32_t n, int64_t x, int64_t y,
+        bit_packed::BitGrid& grid) {
+        const MacroNode& node = nodes[n];
+        if (n == 0 || node.box.empty())
+            return;
+        if (node.level == LEAF_LEVEL) {
+            for (int row = 0; row < 8; row++) {
+                uint64_t bits = (node.leaf >> (8 * row)) & 0xff;
+                while (bits) {
+                    int first = 0;
+                    while (!((bits >> first) & 1))
+                        first++;
+                    int last = first;
+                    while ((bits >> (last + 1)) & 1)
+                        last++;
+                    set_run(grid, y + row, x + first, last - first + 1);
+                    bits &= ~(((2ULL << last) - 1) & ~((1ULL << first) - 1));
+                }
+            }
+            return;
+        }
+        int64_t half = (int64_t)1 << (node.level - 1);
+        for (int q = 0; q < 4; q++)
+            render_macro(nodes, node.child[q], x + (q & 1) * half, y + (q >> 1) * half, grid);
+    }
+
+    static bool parse_macrocell(const char* begin, const char* end, bit_packed::BitGrid& grid) {
+        const char* first = begin;
+        while (first < end && (*first == '[' || *first == '#'))
+            first = skip_line(first, end);
+
+        // node numbers are line numbers, so count the node lines of every chunk first
+        std::vector<const char*> bounds = split_lines(first, end);
+        int chunk_count = (int)bounds.size() - 1;
+        std::vector<size_t> first_index(chunk_count + 1, 1);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++) {
+            size_t count = 0;
+            for (const char* p = bounds[c]; p < bounds[c + 1]; p = skip_line(p, bounds[c + 1]))
+                count += !is_space(*p) && *p != '#';
+            first_index[c + 1] = count;
+        }
+        for (int c = 0; c < chunk_count; c++)
+            first_index[c + 1] += first_index[c];
+        size_t node_count = first_index[chunk_count];
+        if (node_count < 2 || node_count > UINT32_MAX)
+            return false;
+
+        std::vector<MacroNode> nodes(node_count);
+        std::vector<uint8_t> failed(chunk_count, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < chunk_count; c++) {
+            size_t index = first_index[c];
+            for (const char* p = bounds[c]; p < bounds[c + 1]; ) {
+                const char* line_end = skip_line(p, bounds[c + 1]);
+                if (!is_space(*p) && *p != '#') {
+                    if (!parse_macro_line(p, line_end, nodes[index])) {
+                        failed[c] = 1;
+                        break;
+                    }
+                    index++;
+                }
+                p = line_end;
+            }
+        }
+        for (int c = 0; c < chunk_count; c++) {
+            if (failed[c])
+                return false;
+        }
+
+        // children always come before their parent, so one forward pass fills
+        // in every bounding box
+        for (size_t n = 1; n < node_count; n++) {
+            MacroNode& node = nodes[n];
+            if (node.level == LEAF_LEVEL) {
+                for (int bit = 0; bit < 64; bit++) {
+                    if ((node.leaf >> bit) & 1)
+                        node.box.add(bit % 8, bit / 8);
+                }
+                continue;
+            }
+            int64_t half = (int64_t)1 << (node.level - 1);
+            for (int q = 0; q < 4; q++) {
+                uint32_t child = node.child[q];
+                if (child >= n || (child != 0 && nodes[child].level != node.level - 1))
+                    return false;
+                node.box.add(nodes[child].box, (q & 1) * half, (q >> 1) * half);
+            }
+        }
+
+        uint32_t root = (uint32_t)(node_count - 1);
+        const Box& box = nodes[root].box;
+        if (!make_grid(box, grid))
+            return false;
+
+        // expand the top of the tree until there is enough independent work
+        struct Task {
+            uint32_t node;
+            int64_t x, y;
+        };
+        std::vector<Task> tasks(1, Task{ root, -box.min_x, -box.min_y });
+        size_t wanted = (size_t)omp_get_max_threads() * 8;
+        while (tasks.size() < wanted && nodes[tasks[0].node].level > LEAF_LEVEL) {
+            std::vector<Task> expanded;
+            for (const Task& task : tasks) {
+                const MacroNode& node = nodes[task.node];
+                int64_t half = (int64_t)1 << (node.level - 1);
+                for (int q = 0; q < 4; q++) {
+                    if (node.child[q] != 0 && !nodes[node.child[q]].box.empty())
+                        expanded.push_back(Task{ node.child[q], task.x + (q & 1) * half, task.y + (q >> 1) * half });
+                }
+            }
+            if (expanded.empty())
+                break;
+            tasks.swap(expanded);
+        }
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int t = 0; t < (int)tasks.size(); t++)
+            render_macro(nodes, tasks[t].node, tasks[t].x, tasks[t].y, grid);
+        return true;
+    }
+
+    static bool starts_with(const char* p, const char* end, const char* prefix) {
+        size_t length = std::strlen(prefix);
+        return (size_t)(end - p) >= length && std::memcmp(p, prefix, length) == 0;
+    }
+
+    template <typename Parser>
+    static bool load_mapped(const char* path, bit_packed::BitGrid& grid, Parser parse) {
+        MappedFile file(path);
+        if (!file.ok() || file.size() == 0)
+            return false;
+        return parse(file.data(), file.data() + file.size(), grid);
+    }
+
+    bool load_rle(const char* path, bit_packed::BitGrid& grid) {
+        return load_mapped(path, grid, parse_rle);
+    }
+
+    bool load_life106(const char* path, bit_packed::BitGrid& grid) {
+        return load_mapped(path, grid, parse_life106);
+    }
+
+    bool load_macrocell(const char* path, bit_packed::BitGrid& grid) {
+        return load_mapped(path, grid, parse_macrocell);
+    }
+
+    bool load_pattern(const char* path, bit_packed::BitGrid& grid) {
+        return load_mapped(path, grid, [](const char* begin, const char* end, bit_packed::BitGrid& out) {
+            if (starts_with(begin, end, "[M2]"))
+                return parse_macrocell(begin, end, out);
+            if (starts_with(begin, end, "#Life 1.06"))
+                return parse_life106(begin, end, out);
+            return parse_rle(begin, end, out);
+        });
+    }
+
+    //int main()
+    //{
+    //    bit_packed::BitGrid grid;
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    if (!load_pattern("pattern.rle", grid))
+    //        std::cout << "Could not load pattern.rle" << std::endl;
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << grid.rows << "x" << grid.cols << " loaded in " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
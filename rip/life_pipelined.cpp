@@ -0,0 +1,146 @@
+#include "game_of_life.h"
+#include <algorithm>
+
+namespace pipelined_life {
+    const int SPINS_BEFORE_YIELD = 256;
+
+    PipelinedLife::PipelinedLife(int rows, int cols, int threads)
+        : buffers{ halo_grid::HaloGrid(rows, cols), halo_grid::HaloGrid(rows, cols) } {
+        if (threads <= 0)
+            threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max(1, std::min(threads, rows));
+        bands = std::vector<Band>(threads);
+        int base = rows / threads, remainder = rows % threads;
+        for (int t = 0, row = 0; t < threads; t++) {
+            bands[t].first_row = row;
+            bands[t].rows = base + (t < remainder ? 1 : 0);
+            row += bands[t].rows;
+        }
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back(&PipelinedLife::run, this, t);
+    }
+
+    PipelinedLife::~PipelinedLife() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    void PipelinedLife::load_matrix(const std::vector<std::vector<int>>& matrix) {
+        halo_grid::load_matrix(buffers[0], matrix);
+        generation_count = 0;
+        for (Band& band : bands)
+            band.done.store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<std::vector<int>> PipelinedLife::to_matrix() const {
+        return halo_grid::to_matrix(buffers[generation_count & 1]);
+    }
+
+    void PipelinedLife::advance(int generations, bool wrap) {
+        if (generations <= 0)
+            return;
+        // Row halos are never read in the wrap mode, the band owning row 0 or the
+        // last row reads the opposite edge directly. Column halos are written by
+        // the owner of each row together with the row itself.
+        buffers[0].fill_halo(wrap);
+        buffers[1].fill_halo(wrap);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            target = generation_count + generations;
+            wrap_mode = wrap;
+            running = (int)bands.size();
+            run_id++;
+        }
+        wake.notify_all();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return running == 0; });
+        generation_count = target;
+    }
+
+    void PipelinedLife::run(int t) {
+        long long seen = 0;
+        for (;;) {
+            long long goal;
+            bool wrap;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || run_id != seen; });
+                if (stopping)
+                    return;
+                seen = run_id;
+                goal = target;
+                wrap = wrap_mode;
+            }
+            advance_band(t, goal, wrap);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+                finished.notify_one();
+        }
+    }
+
+    void PipelinedLife::wait_for(int t, long long generation) const {
+        int spins = 0;
+        while (bands[t].done.load(std::memory_order_acquire) < generation) {
+            if (++spins >= SPINS_BEFORE_YIELD) {
+                std::this_thread::yield();
+                spins = 0;
+            }
+        }
+    }
+
+    // Generation g lives in buffers[g & 1]. Computing g + 1 reads the edge rows
+    // of both neighbours at generation g and overwrites generation g - 1, which
+    // the neighbours read while computing g; both are safe once the neighbours
+    // have finished g. A band therefore never gets more than one generation
+    // ahead of the bands next to it, and never waits for any other band.
+    void PipelinedLife::advance_band(int t, long long goal, bool wrap) {
+        Band& band = bands[t];
+        int threads = (int)bands.size();
+        int rows = buffers[0].rows;
+        int cols = buffers[0].cols;
+        int above = t > 0 ? t - 1 : (wrap ? threads - 1 : -1);
+        int below = t + 1 < threads ? t + 1 : (wrap ? 0 : -1);
+        for (long long g = band.done.load(std::memory_order_relaxed); g < goal; g++) {
+            if (above >= 0)
+                wait_for(above, g);
+            if (below >= 0)
+                wait_for(below, g);
+            const halo_grid::HaloGrid& current = buffers[g & 1];
+            halo_grid::HaloGrid& next = buffers[(g + 1) & 1];
+            for (int i = band.first_row; i < band.first_row + band.rows; i++) {
+                const uint8_t* up = current.row(wrap && i == 0 ? rows - 1 : i - 1);
+                const uint8_t* mid = current.row(i);
+                const uint8_t* down = current.row(wrap && i == rows - 1 ? 0 : i + 1);
+                uint8_t* out = next.row(i);
+                for (int j = 0; j < cols; j++) {
+                    int live_neighbours = up[j - 1] + up[j] + up[j + 1]
+                        + mid[j - 1] + mid[j + 1]
+                        + down[j - 1] + down[j] + down[j + 1];
+                    out[j] = halo_grid::CONWAY_RULE[mid[j]][live_neighbours];
+                }
+                if (wrap) {
+                    out[-1] = out[cols - 1];
+                    out[cols] = out[0];
+                }
+            }
+            band.done.store(g + 1, std::memory_order_release);
+        }
+    }
+
+    //int main()
+    //{
+    //    PipelinedLife life(multi_core::M, multi_core::N);
+    //    life.load_matrix(multi_core::generate_start_values());
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    life.advance(multi_core::NUMBER_OF_ITERATIONS, false);
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "life_rules.h"
+#include <omp.h>
+
+namespace life_rules {
+    // Table-driven kernel for rules that are not built in. The boundary and the
+    // two-state/multi-state split stay compile time, only the table is loaded.
+    template <typename B, int StateClass>
+    static void calculate_with_table(const std::vector<uint8_t>& table, halo_grid::HaloGrid& current,
+        halo_grid::HaloGrid& next) {
+        current.fill_halo(B::wrap);
+        int rows = current.rows;
+        int cols = current.cols;
+        const uint8_t* next_state = table.data();
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < rows; i++) {
+            const uint8_t* up = current.row(i - 1);
+            const uint8_t* mid = current.row(i);
+            const uint8_t* down = current.row(i + 1);
+            uint8_t* out = next.row(i);
+            for (int j = 0; j < cols; j++)
+                out[j] = next_state[mid[j] * 9 + live_neighbours<StateClass>(up, mid, down, j)];
+        }
+    }
+
+    static std::vector<uint8_t> runtime_table(const Rule& rule) {
+        // rows up to MAX_STATES so a stray out-of-range cell cannot index past the end
+        std::vector<uint8_t> table((size_t)MAX_STATES * 9, 0);
+        for (int n = 0; n <= 8; n++) {
+            table[0 * 9 + n] = (rule.birth >> n) & 1 ? 1 : 0;
+            table[1 * 9 + n] = (rule.survive >> n) & 1 ? 1 : (rule.states > 2 ? 2 : 0);
+            for (int s = 2; s < rule.states; s++)
+                table[s * 9 + n] = (uint8_t)(s + 1 < rule.states ? s + 1 : 0);
+        }
+        return table;
+    }
+
+    template <typename B>
+    static void calculate_runtime(const Rule& rule, halo_grid::HaloGrid& current, halo_grid::HaloGrid& next) {
+        std::vector<uint8_t> table = runtime_table(rule);
+        if (rule.states == 2)
+            calculate_with_table<B, 2>(table, current, next);
+        else
+            calculate_with_table<B, MAX_STATES>(table, current, next);
+    }
+
+    template <typename... Builtin>
+    struct Dispatch;
+
+    template <>
+    struct Dispatch<> {
+        static void run(const Rule& rule, halo_grid::HaloGrid& current, halo_grid::HaloGrid& next, bool wrap) {
+            if (wrap)
+                calculate_runtime<Torus>(rule, current, next);
+            else
+                calculate_runtime<Finite>(rule, current, next);
+        }
+    };
+
+    template <typename R, typename... Rest>
+    struct Dispatch<R, Rest...> {
+        static void run(const Rule& rule, halo_grid::HaloGrid& current, halo_grid::HaloGrid& next, bool wrap) {
+            if (rule != R::rule)
+                Dispatch<Rest...>::run(rule, current, next, wrap);
+            else if (wrap)
+                life_rules::calculate_next_generation<R, Torus>(current, next);
+            else
+                life_rules::calculate_next_generation<R, Finite>(current, next);
+        }
+    };
+
+    bool calculate_next_generation(const Rule& rule, halo_grid::HaloGrid& current, halo_grid::HaloGrid& next,
+        bool wrap) {
+        if (!rule.valid)
+            return false;
+        Dispatch<Conway, HighLife, DayAndNight, Seeds, BriansBrain, StarWars>::run(rule, current, next, wrap);
+        return true;
+    }
+
+    bool calculate_next_generation(const Rule& rule, const bit_packed::BitGrid& current, bit_packed::BitGrid& next,
+        bool wrap) {
+        if (!rule.valid || rule.states != 2)
+            return false;
+        bit_packed::calculate_next_generation(current, next, wrap, rule.birth, rule.survive);
+        return true;
+    }
+
+    //int main()
+    //{
+    //    Rule rule = parse_rule("B36/S23");
+    //    halo_grid::HaloGrid current(multi_core::M, multi_core::N), next(multi_core::M, multi_core::N);
+    //    halo_grid::load_matrix(current, multi_core::generate_start_values());
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    for (int iteration = 0; iteration < multi_core::NUMBER_OF_ITERATIONS; iteration++) {
+    //        calculate_next_generation(rule, current, next, true);
+    //        std::swap(current, next);
+    //    }
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
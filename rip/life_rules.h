@@ -0,0 +1,155 @@
+#pragma once
+#include "game_of_life.h"
+#include <array>
+
+// Outer-totalistic rules (B/S notation) and their multi-state Generations
+// variant. A rule string is parsed into birth/survive neighbour-count masks by
+// a constexpr parser, so built-in rules are compile-time constants and every
+// rule/boundary pair instantiates its own kernel with the lookup table and the
+// boundary mode folded in. Rules only known at run time go through the
+// dispatchers at the bottom of the file.
+
+namespace life_rules {
+    const int MAX_STATES = 256;
+
+    struct Rule {
+        uint16_t birth = 0;   // bit n: a dead cell with n live neighbours is born
+        uint16_t survive = 0; // bit n: a live cell with n live neighbours stays alive
+        // 2 for plain B/S rules. Generations rules (more than 2 states) age a
+        // live cell that does not survive through states 2 .. states - 1 back
+        // to 0; only state 1 counts as a live neighbour.
+        int states = 2;
+        bool valid = false;
+
+        constexpr bool operator==(const Rule& other) const {
+            return birth == other.birth && survive == other.survive && states == other.states && valid == other.valid;
+        }
+        constexpr bool operator!=(const Rule& other) const { return !(*this == other); }
+    };
+
+    // Accepts "B3/S23" style strings (letters in either case and order, plus an
+    // optional "/C<states>" or "/G<states>"), the classic "23/3" S/B form and
+    // Golly's "345/2/4" S/B/C Generations form. Returns a rule with valid unset
+    // when the string is malformed.
+    constexpr Rule parse_rule(const char* text) {
+        Rule rule;
+        char kind[3] = { 0, 0, 0 };
+        uint16_t digits[3] = { 0, 0, 0 };
+        int number[3] = { 0, 0, 0 };
+        bool has_digits[3] = { false, false, false };
+        int field = 0;
+        for (const char* p = text; *p; p++) {
+            char c = *p;
+            if (c == '/') {
+                if (++field > 2)
+                    return rule;
+            }
+            else if (c >= '0' && c <= '9') {
+                digits[field] |= (uint16_t)(1 << (c - '0'));
+                number[field] = number[field] * 10 + (c - '0');
+                has_digits[field] = true;
+                if (number[field] > MAX_STATES)
+                    number[field] = MAX_STATES + 1;
+            }
+            else {
+                char upper = c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : c;
+                if (kind[field] != 0 || has_digits[field]
+                    || (upper != 'B' && upper != 'S' && upper != 'C' && upper != 'G'))
+                    return rule;
+                kind[field] = upper == 'G' ? 'C' : upper;
+            }
+        }
+
+        bool lettered = kind[0] != 0 || kind[1] != 0 || kind[2] != 0;
+        const char classic[3] = { 'S', 'B', 'C' };
+        bool seen_b = false, seen_s = false, seen_c = false;
+        for (int f = 0; f <= field; f++) {
+            char role = lettered ? kind[f] : classic[f];
+            if (role == 'B' || role == 'S') {
+                if ((role == 'B' ? seen_b : seen_s) || (digits[f] >> 9) != 0)
+                    return rule;
+                (role == 'B' ? rule.birth : rule.survive) = digits[f];
+                (role == 'B' ? seen_b : seen_s) = true;
+            }
+            else if (role == 'C') {
+                if (seen_c || number[f] < 2 || number[f] > MAX_STATES)
+                    return rule;
+                rule.states = number[f];
+                seen_c = true;
+            }
+            else {
+                return rule;
+            }
+        }
+        rule.valid = seen_b && seen_s;
+        return rule;
+    }
+
+    struct Conway { static constexpr Rule rule = parse_rule("B3/S23"); };
+    struct HighLife { static constexpr Rule rule = parse_rule("B36/S23"); };
+    struct DayAndNight { static constexpr Rule rule = parse_rule("B3678/S34678"); };
+    struct Seeds { static constexpr Rule rule = parse_rule("B2/S"); };
+    struct BriansBrain { static constexpr Rule rule = parse_rule("B2/S/C3"); };
+    struct StarWars { static constexpr Rule rule = parse_rule("B2/S345/C4"); };
+
+    struct Torus { static constexpr bool wrap = true; };
+    struct Finite { static constexpr bool wrap = false; };
+
+    // next state indexed by [state][live neighbours]
+    template <int States>
+    using Table = std::array<std::array<uint8_t, 9>, States>;
+
+    template <int States>
+    constexpr Table<States> make_table(const Rule& rule) {
+        Table<States> table{};
+        for (int n = 0; n <= 8; n++) {
+            table[0][n] = (rule.birth >> n) & 1 ? 1 : 0;
+            table[1][n] = (rule.survive >> n) & 1 ? 1 : (States > 2 ? 2 : 0);
+            for (int s = 2; s < States; s++)
+                table[s][n] = (uint8_t)(s + 1 < States ? s + 1 : 0);
+        }
+        return table;
+    }
+
+    // Live neighbours of mid[j]. Two-state grids hold 0/1 and are summed as is.
+    template <int States>
+    inline int live_neighbours(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int j) {
+        if constexpr (States == 2) {
+            return up[j - 1] + up[j] + up[j + 1] + mid[j - 1] + mid[j + 1] + down[j - 1] + down[j] + down[j + 1];
+        }
+        else {
+            return (up[j - 1] == 1) + (up[j] == 1) + (up[j + 1] == 1) + (mid[j - 1] == 1) + (mid[j + 1] == 1)
+                + (down[j - 1] == 1) + (down[j] == 1) + (down[j + 1] == 1);
+        }
+    }
+
+    // One generation of rule R (a type with a static constexpr Rule rule) under
+    // boundary B (Torus or Finite) on a halo grid. Cells hold the state number.
+    template <typename R, typename B>
+    void calculate_next_generation(halo_grid::HaloGrid& current, halo_grid::HaloGrid& next) {
+        static_assert(R::rule.valid, "malformed rule string");
+        constexpr int states = R::rule.states;
+        static constexpr Table<states> table = make_table<states>(R::rule);
+        current.fill_halo(B::wrap);
+        int rows = current.rows;
+        int cols = current.cols;
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < rows; i++) {
+            const uint8_t* up = current.row(i - 1);
+            const uint8_t* mid = current.row(i);
+            const uint8_t* down = current.row(i + 1);
+            uint8_t* out = next.row(i);
+            for (int j = 0; j < cols; j++)
+                out[j] = table[mid[j]][live_neighbours<states>(up, mid, down, j)];
+        }
+    }
+
+    // Runs the compiled kernel when rule is one of the built-in rules above and
+    // a table-driven kernel otherwise. Returns false for an invalid rule.
+    bool calculate_next_generation(const Rule& rule, halo_grid::HaloGrid& current, halo_grid::HaloGrid& next,
+        bool wrap);
+    // Bit-sliced version for two-state rules. Returns false for an invalid or a
+    // Generations rule.
+    bool calculate_next_generation(const Rule& rule, const bit_packed::BitGrid& current, bit_packed::BitGrid& next,
+        bool wrap);
+}
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "game_of_life.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace streaming_life {
+    const char MAGIC[8] = { 'L', 'I', 'F', 'E', 'B', 'I', 'T', 'S' };
+    const int64_t HEADER_BYTES = 24;
+    const int QUEUE_ROWS = 16;
+    const size_t IO_BUFFER_BYTES = (size_t)4 << 20;
+
+    static bool seek(FILE* file, int64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+
+    static bool read_header(FILE* file, uint64_t& rows, uint64_t& cols) {
+        char magic[8];
+        return std::fread(magic, 1, 8, file) == 8 && std::memcmp(magic, MAGIC, 8) == 0
+            && std::fread(&rows, sizeof(rows), 1, file) == 1
+            && std::fread(&cols, sizeof(cols), 1, file) == 1;
+    }
+
+    static bool write_header(FILE* file, uint64_t rows, uint64_t cols) {
+        return std::fwrite(MAGIC, 1, 8, file) == 8
+            && std::fwrite(&rows, sizeof(rows), 1, file) == 1
+            && std::fwrite(&cols, sizeof(cols), 1, file) == 1;
+    }
+
+    bool write_grid_file(const char* path, const bit_packed::BitGrid& grid) {
+        FILE* file = std::fopen(path, "wb");
+        if (!file)
+            return false;
+        bool ok = write_header(file, grid.rows, grid.cols)
+            && std::fwrite(grid.words.data(), sizeof(uint64_t), (size_t)grid.rows * grid.words_per_row, file)
+                == (size_t)grid.rows * grid.words_per_row;
+        return std::fclose(file) == 0 && ok;
+    }
+
+    bool read_grid_file(const char* path, bit_packed::BitGrid& grid) {
+        FILE* file = std::fopen(path, "rb");
+        if (!file)
+            return false;
+        uint64_t rows, cols;
+        bool ok = read_header(file, rows, cols);
+        if (ok) {
+            grid = bit_packed::BitGrid((int)rows, (int)cols);
+            size_t words = (size_t)grid.rows * grid.words_per_row;
+            ok = std::fread(grid.words.data(), sizeof(uint64_t), words, file) == words;
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    // Bounded single-producer single-consumer queue of packed rows. Slots are
+    // allocated once; producers fill a slot in place and consumers read it in
+    // place, so rows are never copied through the queue.
+    class RowQueue {
+    public:
+        RowQueue(size_t words, int capacity) : words(words), capacity(capacity), storage(words * capacity) {}
+
+        uint64_t* begin_push() {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock, [this] { return pushed - popped < capacity; });
+            return storage.data() + (size_t)(pushed % capacity) * words;
+        }
+
+        void end_push() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pushed++;
+            }
+            not_empty.notify_one();
+        }
+
+        const uint64_t* begin_pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this] { return popped < pushed; });
+            return storage.data() + (size_t)(popped % capacity) * words;
+        }
+
+        void end_pop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                popped++;
+            }
+            not_full.notify_one();
+        }
+
+    private:
+        size_t words;
+        int64_t capacity;
+        std::vector<uint64_t> storage;
+        int64_t pushed = 0;
+        int64_t popped = 0;
+        std::mutex mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+
+    // Reads every row in file order. On a read error the remaining rows are
+    // zeros, so the pipeline still drains, and failed is set.
+    static void run_reader(FILE* file, RowQueue& out, int64_t rows, size_t words, std::atomic<bool>& failed) {
+        for (int64_t r = 0; r < rows; r++) {
+            uint64_t* row = out.begin_push();
+            if (failed || std::fread(row, sizeof(uint64_t), words, file) != words) {
+                std::memset(row, 0, words * sizeof(uint64_t));
+                failed = true;
+            }
+            out.end_push();
+        }
+    }
+
+    // One generation over a rolling three-row window. In finite mode rows come
+    // out in input order. In wrap mode row 0 needs the last row, so the first
+    // two rows are kept and row 0 is emitted last: the output is the input
+    // rotated by one row, which the writer undoes.
+    static void run_stage(RowQueue& in, RowQueue& out, int64_t rows, int cols, size_t words, bool wrap) {
+        std::vector<uint64_t> window(3 * words), first(words), second(words), zero(words, 0);
+        auto row_of = [&](int64_t r) { return window.data() + (size_t)(r % 3) * words; };
+        auto emit = [&](const uint64_t* up, const uint64_t* mid, const uint64_t* down) {
+            uint64_t* row = out.begin_push();
+            bit_packed::calculate_next_row(up, mid, down, row, cols, wrap);
+            out.end_push();
+        };
+
+        for (int64_t r = 0; r < rows; r++) {
+            std::memcpy(row_of(r), in.begin_pop(), words * sizeof(uint64_t));
+            in.end_pop();
+            if (wrap && r == 0)
+                std::memcpy(first.data(), row_of(r), words * sizeof(uint64_t));
+            if (wrap && r == 1)
+                std::memcpy(second.data(), row_of(r), words * sizeof(uint64_t));
+            if (!wrap && r >= 1)
+                emit(r >= 2 ? row_of(r - 2) : zero.data(), row_of(r - 1), row_of(r));
+            if (wrap && r >= 2)
+                emit(row_of(r - 2), row_of(r - 1), row_of(r));
+        }
+
+        if (!wrap) {
+            emit(rows >= 2 ? row_of(rows - 2) : zero.data(), row_of(rows - 1), zero.data());
+        }
+        else if (rows == 1) {
+            emit(first.data(), first.data(), first.data());
+        }
+        else {
+            emit(row_of(rows - 2), row_of(rows - 1), first.data());
+            emit(row_of(rows - 1), first.data(), second.data());
+        }
+    }
+
+    // Writes the rows of the last stage, which start at file row `rotation`.
+    static void run_writer(FILE* file, RowQueue& in, int64_t rows, size_t words, int64_t rotation,
+        std::atomic<bool>& failed) {
+        int64_t row_bytes = (int64_t)(words * sizeof(uint64_t));
+        if (!seek(file, HEADER_BYTES + rotation * row_bytes))
+            failed = true;
+        for (int64_t r = 0; r < rows; r++) {
+            int64_t target = (rotation + r) % rows;
+            if (target == 0 && r != 0 && !seek(file, HEADER_BYTES))
+                failed = true;
+            const uint64_t* row = in.begin_pop();
+            if (!failed && std::fwrite(row, sizeof(uint64_t), words, file) != words)
+                failed = true;
+            in.end_pop();
+        }
+    }
+
+    static bool stream_pass(const char* in_path, const char* out_path, int generations, bool wrap) {
+        FILE* in = std::fopen(in_path, "rb");
+        if (!in)
+            return false;
+        std::setvbuf(in, NULL, _IOFBF, IO_BUFFER_BYTES);
+        uint64_t rows, cols;
+        if (!read_header(in, rows, cols) || rows == 0 || cols == 0) {
+            std::fclose(in);
+            return false;
+        }
+        FILE* out = std::fopen(out_path, "wb");
+        if (!out) {
+            std::fclose(in);
+            return false;
+        }
+        std::setvbuf(out, NULL, _IOFBF, IO_BUFFER_BYTES);
+        std::atomic<bool> read_failed(false), write_failed(!write_header(out, rows, cols));
+
+        size_t words = (size_t)((cols + 63) / 64);
+        std::vector<std::unique_ptr<RowQueue>> queues;
+        for (int q = 0; q <= generations; q++)
+            queues.emplace_back(new RowQueue(words, QUEUE_ROWS));
+
+        std::vector<std::thread> threads;
+        threads.emplace_back(run_reader, in, std::ref(*queues[0]), (int64_t)rows, words, std::ref(read_failed));
+        for (int g = 0; g < generations; g++)
+            threads.emplace_back(run_stage, std::ref(*queues[g]), std::ref(*queues[g + 1]), (int64_t)rows, (int)cols, words, wrap);
+        int64_t rotation = wrap ? generations % (int64_t)rows : 0;
+        run_writer(out, *queues[generations], (int64_t)rows, words, rotation, write_failed);
+        for (auto& thread : threads)
+            thread.join();
+
+        std::fclose(in);
+        bool closed = std::fclose(out) == 0;
+        return closed && !read_failed && !write_failed;
+    }
+
+    bool stream_generations(const char* in_path, const char* out_path, int generations, bool wrap, int stages) {
+        if (stages < 1)
+            stages = 1;
+        int passes = generations <= 0 ? 1 : (generations + stages - 1) / stages;
+        // passes alternate between out_path and a scratch file so the last one
+        // lands in out_path
+        std::string scratch = std::string(out_path) + ".tmp";
+        std::string source = in_path;
+        bool ok = true;
+        for (int p = 0; p < passes && ok; p++) {
+            int pass_generations = generations <= 0 ? 0 : std::min(stages, generations - p * stages);
+            std::string target = (passes - 1 - p) % 2 == 0 ? out_path : scratch;
+            ok = stream_pass(source.c_str(), target.c_str(), pass_generations, wrap);
+            source = target;
+        }
+        std::remove(scratch.c_str());
+        return ok;
+    }
+
+    //int main()
+    //{
+    //    bit_packed::BitGrid grid = bit_packed::from_matrix(multi_core::generate_start_values());
+    //    write_grid_file("start.life", grid);
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    if (!stream_generations("start.life", "end.life", multi_core::NUMBER_OF_ITERATIONS, true, 8))
+    //        std::cout << "Streaming failed" << std::endl;
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "game_of_life.h"
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace temporal_blocking {
+    const size_t DEFAULT_CACHE_BYTES = 256 * 1024;
+
+    static size_t detect_l2_cache_bytes() {
+#ifdef _WIN32
+        DWORD length = 0;
+        GetLogicalProcessorInformation(NULL, &length);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!info.empty() && GetLogicalProcessorInformation(info.data(), &length)) {
+            for (const auto& entry : info) {
+                if (entry.Relationship == RelationCache && entry.Cache.Level == 2)
+                    return entry.Cache.Size;
+            }
+        }
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+        long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0)
+            return (size_t)size;
+#endif
+        return DEFAULT_CACHE_BYTES;
+    }
+
+    Parameters auto_parameters(size_t cache_bytes) {
+        if (cache_bytes == 0)
+            cache_bytes = detect_l2_cache_bytes();
+        // two one-byte scratch generations of side x side, leaving half the cache
+        // for the rows being copied in and written back
+        int side = (int)std::sqrt((double)cache_bytes / 4);
+        // a ghost zone of side/16 costs roughly 25% redundant work per tile
+        int k = std::max(1, std::min(32, side / 16));
+        Parameters parameters;
+        parameters.generations_per_block = k;
+        parameters.tile_size = std::max(8, side - 2 * k);
+        return parameters;
+    }
+
+    BlockedLife::BlockedLife(int rows, int cols, Parameters parameters)
+        : buffers{ halo_grid::HaloGrid(rows, cols), halo_grid::HaloGrid(rows, cols) },
+          params(parameters),
+          tiles_x((cols + parameters.tile_size - 1) / parameters.tile_size),
+          tiles_y((rows + parameters.tile_size - 1) / parameters.tile_size),
+          scratch(omp_get_max_threads()) {
+        int side = parameters.tile_size + 2 * parameters.generations_per_block;
+        for (auto& area : scratch)
+            area.resize((size_t)2 * side * side);
+    }
+
+    void BlockedLife::load_matrix(const std::vector<std::vector<int>>& matrix) {
+        halo_grid::load_matrix(buffers[front], matrix);
+    }
+
+    std::vector<std::vector<int>> BlockedLife::to_matrix() const {
+        return halo_grid::to_matrix(current());
+    }
+
+    size_t BlockedLife::footprint_bytes() const {
+        size_t bytes = buffers[0].cells.capacity() + buffers[1].cells.capacity();
+        for (const auto& area : scratch)
+            bytes += area.capacity();
+        return bytes;
+    }
+
+    void BlockedLife::advance_tile(int tile, int generations, bool wrap, std::vector<uint8_t>& area) {
+        const halo_grid::HaloGrid& cur = buffers[front];
+        halo_grid::HaloGrid& next = buffers[1 - front];
+        int rows = cur.rows;
+        int cols = cur.cols;
+        int k = generations;
+        int row0 = (tile / tiles_x) * params.tile_size;
+        int col0 = (tile % tiles_x) * params.tile_size;
+        int tile_rows = std::min(params.tile_size, rows - row0);
+        int tile_cols = std::min(params.tile_size, cols - col0);
+        int height = tile_rows + 2 * k;
+        int width = tile_cols + 2 * k;
+        uint8_t* src = area.data();
+        uint8_t* dst = area.data() + (size_t)height * width;
+
+        // local cells that map onto the board; in finite mode everything else
+        // stays dead in both scratch generations
+        int row_lo = 0, row_hi = height, col_lo = 0, col_hi = width;
+        if (!wrap) {
+            row_lo = std::max(0, k - row0);
+            row_hi = std::min(height, rows - row0 + k);
+            col_lo = std::max(0, k - col0);
+            col_hi = std::min(width, cols - col0 + k);
+        }
+        std::memset(src, 0, (size_t)height * width);
+        std::memset(dst, 0, (size_t)height * width);
+        for (int r = row_lo; r < row_hi; r++) {
+            int i = row0 - k + r;
+            if (wrap)
+                i = ((i % rows) + rows) % rows;
+            const uint8_t* board_row = cur.row(i);
+            uint8_t* local = src + (size_t)r * width;
+            for (int c = col_lo; c < col_hi; c++) {
+                int j = col0 - k + c;
+                if (wrap)
+                    j = ((j % cols) + cols) % cols;
+                local[c] = board_row[j];
+            }
+        }
+
+        for (int g = 1; g <= k; g++) {
+            int r_begin = std::max(g, row_lo), r_end = std::min(height - g, row_hi);
+            int c_begin = std::max(g, col_lo), c_end = std::min(width - g, col_hi);
+            for (int r = r_begin; r < r_end; r++) {
+                const uint8_t* up = src + (size_t)(r - 1) * width;
+                const uint8_t* mid = src + (size_t)r * width;
+                const uint8_t* down = src + (size_t)(r + 1) * width;
+                uint8_t* out = dst + (size_t)r * width;
+                for (int c = c_begin; c < c_end; c++) {
+                    int live_neighbours = up[c - 1] + up[c] + up[c + 1]
+                        + mid[c - 1] + mid[c + 1]
+                        + down[c - 1] + down[c] + down[c + 1];
+                    out[c] = halo_grid::CONWAY_RULE[mid[c]][live_neighbours];
+                }
+            }
+            std::swap(src, dst);
+        }
+
+        for (int r = 0; r < tile_rows; r++) {
+            std::memcpy(next.row(row0 + r) + col0, src + (size_t)(r + k) * width + k, tile_cols);
+        }
+    }
+
+    void BlockedLife::advance_block(int generations, bool wrap) {
+        int tile_count = tiles_x * tiles_y;
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int tile = 0; tile < tile_count; tile++) {
+            advance_tile(tile, generations, wrap, scratch[omp_get_thread_num()]);
+        }
+        front = 1 - front;
+    }
+
+    void BlockedLife::advance(int generations, bool wrap) {
+        // the caller may have raised the thread count since construction
+        int threads = omp_get_max_threads();
+        if ((int)scratch.size() < threads) {
+            int side = params.tile_size + 2 * params.generations_per_block;
+            scratch.resize(threads, std::vector<uint8_t>((size_t)2 * side * side));
+        }
+        while (generations > 0) {
+            int block = std::min(generations, params.generations_per_block);
+            advance_block(block, wrap);
+            generations -= block;
+        }
+    }
+
+    //int main()
+    //{
+    //    BlockedLife life(16384, 16384);
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    life.advance(multi_core::NUMBER_OF_ITERATIONS, true);
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    //    std::cout << "k = " << life.parameters().generations_per_block << ", time elapsed: " << duration.count() << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include "game_of_life.h"
 #include <iostream>
 #include <omp.h>
 #include <vector>
@@ -22,7 +23,7 @@ namespace multi_core {
         return matrix;
     }
 
-    int calculate_live_neighbours(std::vector<std::vector<int>> matrix, int i, int j) {
+    int calculate_live_neighbours(const std::vector<std::vector<int>>& matrix, int i, int j) {
         int live_neighbours = 0;
         for (int x = i - 1; x < i + 2; x++) {
             for (int y = j - 1; y < j + 2; y++) {
@@ -37,11 +38,9 @@ namespace multi_core {
         return live_neighbours;
     }
 
-    int calculate_next_generation_for_single_cell(std::vector<std::vector<int>> matrix, int i, int j) {
+    int calculate_next_generation_for_single_cell(const std::vector<std::vector<int>>& matrix, int i, int j) {
         int cell = matrix[i][j];
         int live_neighbours = calculate_live_neighbours(matrix, i, j);
-        if (live_neighbours > 8)
-            std::cout << "";
         if (cell == 1 && live_neighbours < 2) {
             return 0; // underpopulation
         }
@@ -57,7 +56,7 @@ namespace multi_core {
         return cell;
     }
 
-    std::vector<std::vector<int>> calculate_next_generation(std::vector<std::vector<int>> matrix) {
+    std::vector<std::vector<int>> calculate_next_generation(const std::vector<std::vector<int>>& matrix) {
         std::vector<std::vector<int>> next_gen_matrix(M, std::vector<int>(N));
 #pragma omp parallel for schedule(static)
         for (int x = 0; x < M * N; x++) {
@@ -73,14 +72,15 @@ namespace multi_core {
         return next_gen_matrix;
     }
 
-    void show(std::vector<std::vector<int>> matrix) {
-        std::cout << "\x1b[H\x1b[2J";
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) {
-                std::cout << (matrix[i][j] ? "\033[07m  \033[m" : "  ");
-            }
-            std::cout << std::endl;
-        }
+    // Hands the frame to a renderer thread that paces itself (50 ms between
+    // drawn frames) and skips frames while it is busy, so the caller never
+    // waits on the terminal.
+    void show(const std::vector<std::vector<int>>& matrix, bool last = false) {
+        static async_render::TerminalRenderer renderer(M, N, 2, 50);
+        static long long frame = 0;
+        if (renderer.wants_frame() || last)
+            renderer.submit(matrix, frame);
+        frame++;
     }
 
     //int main()
@@ -90,10 +90,8 @@ namespace multi_core {
     //    auto start = std::chrono::high_resolution_clock::now();
     //    while (iteration++ < NUMBER_OF_ITERATIONS) {
     //        if(ENABLE_VISUAL)
-    //            show(matrix);
+    //            show(matrix, iteration == NUMBER_OF_ITERATIONS);
     //        matrix = calculate_next_generation(matrix);
-    //        if(ENABLE_VISUAL)
-    //            std::this_thread::sleep_for(std::chrono::milliseconds(50));
     //    }
     //    auto stop = std::chrono::high_resolution_clock::now();
     //    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
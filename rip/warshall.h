@@ -0,0 +1,297 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Declarations shared by the transitive closure engines. Every engine imports
+// from and exports to the same flat row-major 0/1 adjacency matrix (entry
+// i * n + j is the edge i -> j) that the Warshall programs work on.
+
+namespace bit_warshall {
+    const int CACHE_LINE = 64;
+
+    // std::allocator with every block starting on a cache line.
+    template <typename T>
+    struct CacheAlignedAllocator {
+        using value_type = T;
+
+        CacheAlignedAllocator() = default;
+        template <typename U>
+        CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(CACHE_LINE)));
+        }
+        void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(CACHE_LINE)); }
+
+        template <typename U>
+        bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+        template <typename U>
+        bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+    };
+
+    // One bit per edge: bit b of word w of row i is the edge i -> w * 64 + b.
+    // Every row starts on a cache line and is padded to whole cache lines
+    // (stride words, a multiple of any SIMD width), so a row OR needs no tail
+    // loop. Padding bits are zero and stay zero.
+    struct BitMatrix {
+        int n = 0;
+        int stride = 0;
+        std::vector<uint64_t, CacheAlignedAllocator<uint64_t>> words;
+
+        BitMatrix() = default;
+        explicit BitMatrix(int n);
+
+        uint64_t* row(int i) { return words.data() + (size_t)i * stride; }
+        const uint64_t* row(int i) const { return words.data() + (size_t)i * stride; }
+        bool get(int i, int j) const { return (row(i)[j / 64] >> (j % 64)) & 1; }
+        void set(int i, int j) { row(i)[j / 64] |= 1ULL << (j % 64); }
+        void clear(int i, int j) { row(i)[j / 64] &= ~(1ULL << (j % 64)); }
+    };
+
+    BitMatrix from_matrix(const std::vector<int>& matrix, int n);
+    std::vector<int> to_matrix(const BitMatrix& graph);
+
+    // Index of the lowest set bit; x must not be zero.
+    inline int lowest_bit(uint64_t x) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return (int)index;
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    // dst |= src over words words, SIMD for all but the last few.
+    void or_row(uint64_t* dst, const uint64_t* src, int words);
+    // Warshall's algorithm in place: for every k, each row i with the edge
+    // i -> k takes row k into itself, rows in parallel.
+    void transitive_closure(BitMatrix& graph);
+
+    const int DEFAULT_BLOCK_SIZE = 512;
+    // Blocked Warshall in place. The matrix is cut into block_size x block_size
+    // tiles (block_size is rounded up to a multiple of 64; a tile takes
+    // block_size^2 / 8 bytes, 32 KB at the default). For each diagonal block
+    // the diagonal tile is closed, then its row and column panels, then every
+    // other tile, each phase shared out tile by tile with a dynamic omp for
+    // (OpenMP 2.0, so it builds with MSVC's /openmp), so there are n / block_size
+    // synchronisation points instead of n and every tile is worked on while it
+    // sits in cache.
+    void transitive_closure_blocked(BitMatrix& graph, int block_size = DEFAULT_BLOCK_SIZE);
+    const char* simd_path();
+}
+
+namespace scc_closure {
+    // Compressed sparse rows: the successors of u are
+    // targets[offsets[u]] .. targets[offsets[u + 1] - 1].
+    struct CsrGraph {
+        int n = 0;
+        std::vector<int64_t> offsets;
+        std::vector<int> targets;
+    };
+
+    CsrGraph from_edges(int n, const std::vector<std::pair<int, int>>& edges);
+    CsrGraph from_matrix(const std::vector<int>& matrix, int n);
+
+    // Strongly connected components, numbered in the order Tarjan's algorithm
+    // completes them, which is a reverse topological order of the condensation:
+    // every dag edge goes from a higher to a lower component number. A
+    // component is cyclic when it has more than one vertex or a self-loop, i.e.
+    // when its vertices reach themselves.
+    struct Condensation {
+        int components = 0;
+        std::vector<int> component;
+        std::vector<char> cyclic;
+        CsrGraph dag;           // edges between components, no duplicates
+        std::vector<int> level; // 0 for sinks, else 1 + highest successor level
+    };
+
+    Condensation condense(const CsrGraph& graph);
+
+    // Reachability between components, one bit row per component. Row c holds
+    // every component reachable from c over at least one edge, c itself only
+    // when it is cyclic, so reaches() matches the dense Warshall closure. Takes
+    // components^2 / 8 bytes instead of n^2 / 8: a saving only as far as cycles
+    // collapse vertices. A mostly acyclic graph keeps about n components, so a
+    // million vertices still need about 125 GB.
+    struct Closure {
+        std::vector<int> component;
+        bit_warshall::BitMatrix reach;
+
+        bool reaches(int u, int v) const { return reach.get(component[u], component[v]); }
+    };
+
+    // Condenses the graph, then builds the rows sinks first: a row is its
+    // successors plus their rows. All components on one level depend only on
+    // lower levels, so each level is built in parallel.
+    Closure transitive_closure(const CsrGraph& graph);
+    std::vector<int> to_matrix(const Closure& closure);
+}
+
+namespace dynamic_closure {
+    struct Update {
+        int from = 0;
+        int to = 0;
+        bool insert = true; // false removes the edge
+    };
+
+    const double DEFAULT_REBUILD_FRACTION = 0.25;
+
+    // Transitive closure kept up to date under edge updates, with the same
+    // meaning as the Warshall closure (v reaches itself only on a cycle), so
+    // reaches() is a single bit test at any time. Updates come in batches:
+    // - an inserted edge u -> v ORs row v plus v into every row that reaches
+    //   u, rows in parallel;
+    // - a removed edge u -> v can only invalidate the rows that reached u.
+    //   Those are rebuilt by searching the edges, stopping at every unaffected
+    //   vertex whose row is still exact; when more than rebuild_fraction of
+    //   all rows are affected the whole closure is rebuilt with the blocked
+    //   kernel instead.
+    class DynamicClosure {
+    public:
+        explicit DynamicClosure(int n, double rebuild_fraction = DEFAULT_REBUILD_FRACTION);
+        explicit DynamicClosure(const bit_warshall::BitMatrix& edges,
+            double rebuild_fraction = DEFAULT_REBUILD_FRACTION);
+
+        // Removals and insertions take effect in batch order; the closure is
+        // brought up to date once for the whole batch.
+        void apply(const std::vector<Update>& batch);
+        void insert(int from, int to) { apply({ { from, to, true } }); }
+        void erase(int from, int to) { apply({ { from, to, false } }); }
+
+        bool has_edge(int from, int to) const { return edges.get(from, to); }
+        bool reaches(int from, int to) const { return reach.get(from, to); }
+        const bit_warshall::BitMatrix& closure() const { return reach; }
+
+        long long rows_recomputed() const { return recomputed; }
+        long long full_rebuilds() const { return rebuilds; }
+
+    private:
+        void rebuild();
+        void close_insertion(int from, int to);
+        void recompute_rows(const std::vector<char>& affected, const std::vector<int>& rows);
+
+        int n;
+        double rebuild_fraction;
+        bit_warshall::BitMatrix edges;
+        bit_warshall::BitMatrix reach;
+        long long recomputed = 0;
+        long long rebuilds = 0;
+    };
+}
+
+namespace opencl_closure {
+    // Blocked Warshall on an OpenCL device over a bit-packed matrix (32 edges
+    // per uint). Each round closes the diagonal block, then its row and column
+    // panels, then every other block; the pivot loop of a phase runs inside
+    // the kernel from __local copies of the blocks, so a round is three
+    // launches instead of one per vertex. closure() only enqueues work on an
+    // in-order queue and the host synchronises only in snapshot(). Prefers a
+    // GPU and falls back to a CPU device (e.g. PoCL). OpenCL failures throw
+    // std::runtime_error.
+    class OpenCLClosure {
+    public:
+        explicit OpenCLClosure(int n);
+        ~OpenCLClosure();
+        OpenCLClosure(const OpenCLClosure&) = delete;
+        OpenCLClosure& operator=(const OpenCLClosure&) = delete;
+
+        void load_matrix(const bit_warshall::BitMatrix& graph);
+        void closure();
+        bit_warshall::BitMatrix snapshot();
+        const std::string& device_name() const { return device; }
+        int block_size() const { return block; }
+
+    private:
+        bool build_kernels(size_t group);
+        void release();
+
+        struct Handles;
+        Handles* cl;
+        int n;
+        int block = 0;
+        int padded = 0;
+        std::string device;
+    };
+}
+
+namespace closure_trace {
+    // Tracing of the closure kernels. Compiled in when CLOSURE_TRACE is defined
+    // and recording only between start() and stop(), so a traced build costs a
+    // relaxed load per span while tracing is off, and two clock reads plus a
+    // ring write (under 0.1 us) while recording. Every OpenMP thread writes
+    // complete spans into its own preallocated ring, with no locks or shared
+    // writes; when a ring fills up the oldest spans are overwritten and counted
+    // as dropped. After the run the rings are merged into a Chrome trace
+    // (chrome://tracing, ui.perfetto.dev) with a busy/wait summary per thread.
+    enum Kind : uint8_t {
+        K_STEP,     // a thread's share of the rows for one k
+        BLOCK_STEP, // one diagonal block of the blocked closure, all phases
+        DIAGONAL,   // closing the diagonal tile
+        PANEL,      // a row or column panel tile
+        TILE,       // one of the remaining tiles
+        WAIT,       // a thread waiting at a barrier between phases
+        KIND_COUNT
+    };
+
+    struct Span {
+        uint64_t start_ns = 0;
+        uint64_t end_ns = 0;
+        int arg = 0;
+        Kind kind = K_STEP;
+    };
+
+    struct ThreadSummary {
+        int thread = 0;
+        long long spans = 0;
+        long long dropped = 0;
+        // WAIT spans enclose no work, so the two never count the same time
+        double busy_ms = 0; // K_STEP, DIAGONAL, PANEL and TILE spans
+        double wait_ms = 0; // WAIT spans
+    };
+
+    const size_t DEFAULT_SPANS_PER_THREAD = 1 << 18;
+
+    extern std::atomic<bool> recording;
+    inline bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+    // Clears and (re)allocates one ring per OpenMP thread, then starts recording.
+    void start(size_t spans_per_thread = DEFAULT_SPANS_PER_THREAD);
+    void stop();
+    uint64_t now_ns();
+    void record(Kind kind, uint64_t start_ns, uint64_t end_ns, int arg);
+
+    std::vector<ThreadSummary> summarize();
+    bool write_chrome_trace(const std::string& path);
+
+    class Scope {
+    public:
+        Scope(Kind kind, int arg) : kind(kind), arg(arg), on(enabled()), start_ns(on ? now_ns() : 0) {}
+        ~Scope() {
+            if (on)
+                record(kind, start_ns, now_ns(), arg);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Kind kind;
+        int arg;
+        bool on;
+        uint64_t start_ns;
+    };
+}
+
+#ifdef CLOSURE_TRACE
+#define CLOSURE_TRACE_SCOPE(kind, arg) closure_trace::Scope closure_trace_scope_(closure_trace::kind, arg)
+#else
+#define CLOSURE_TRACE_SCOPE(kind, arg) ((void)(arg))
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "warshall.h"
+#include "bit_sliced.h"
+#include <omp.h>
+
+namespace bit_warshall {
+    const int WORDS_PER_LINE = CACHE_LINE / (int)sizeof(uint64_t);
+
+    BitMatrix::BitMatrix(int n)
+        : n(n), stride((n + 64 * WORDS_PER_LINE - 1) / (64 * WORDS_PER_LINE) * WORDS_PER_LINE),
+          words((size_t)n * stride, 0) {
+    }
+
+    BitMatrix from_matrix(const std::vector<int>& matrix, int n) {
+        BitMatrix graph(n);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (matrix[(size_t)i * n + j])
+                    graph.set(i, j);
+            }
+        }
+        return graph;
+    }
+
+    std::vector<int> to_matrix(const BitMatrix& graph) {
+        int n = graph.n;
+        std::vector<int> matrix((size_t)n * n);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++)
+                matrix[(size_t)i * n + j] = graph.get(i, j) ? 1 : 0;
+        }
+        return matrix;
+    }
+
+    void or_row(uint64_t* dst, const uint64_t* src, int words) {
+        int w = 0;
+        for (; w + bit_packed::LANES <= words; w += bit_packed::LANES)
+            (bit_packed::vec::load(dst + w) | bit_packed::vec::load(src + w)).store(dst + w);
+        for (; w < words; w++)
+            dst[w] |= src[w];
+    }
+
+    void transitive_closure(BitMatrix& graph) {
+        int n = graph.n;
+        int stride = graph.stride;
+        // one parallel region for all k; the barrier keeps row k complete
+        // before any row reads it in the next round
+#pragma omp parallel
+        for (int k = 0; k < n; k++) {
+            const uint64_t* row_k = graph.row(k);
+            int word = k / 64;
+            uint64_t bit = 1ULL << (k % 64);
+            {
+                CLOSURE_TRACE_SCOPE(K_STEP, k);
+#pragma omp for schedule(static) nowait
+                for (int i = 0; i < n; i++) {
+                    uint64_t* row_i = graph.row(i);
+                    if (i != k && (row_i[word] & bit))
+                        or_row(row_i, row_k, stride);
+                }
+            }
+            CLOSURE_TRACE_SCOPE(WAIT, k);
+#pragma omp barrier
+        }
+    }
+
+    const char* simd_path() {
+        return bit_packed::SIMD_PATH;
+    }
+
+    //int main()
+    //{
+    //    const int n = 50000;
+    //    std::vector<int> matrix((size_t)n * n);
+    //    for (size_t x = 0; x < matrix.size(); x++)
+    //        matrix[x] = rand() % 20000 == 0 ? 1 : 0;
+    //    BitMatrix graph = from_matrix(matrix, n);
+    //    double start = omp_get_wtime();
+    //    transitive_closure(graph);
+    //    double end = omp_get_wtime();
+    //    std::cout << "Execution time: " << (end - start) * 1000 << " ms (" << simd_path() << ")\n";
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "warshall.h"
+#include "bit_sliced.h"
+#include <omp.h>
+#include <algorithm>
+
+namespace bit_warshall {
+    const int CHUNK_WORDS = 8;
+    const int CHUNK_VECS = CHUNK_WORDS / bit_packed::LANES;
+
+    // A range of vertices, which is also the range of words holding their bits.
+    struct Block {
+        int first = 0;
+        int last = 0;
+        int first_word = 0;
+        int last_word = 0;
+    };
+
+    // The last block reaches to the end of the row padding, which is zero, so
+    // its width stays a whole number of chunks whenever block_size is.
+    static Block block_at(int index, int block_size, const BitMatrix& graph) {
+        Block block;
+        block.first = index * block_size;
+        block.last = std::min(graph.n, block.first + block_size);
+        block.first_word = block.first / 64;
+        block.last_word = block.last == graph.n ? graph.stride : block.last / 64;
+        return block;
+    }
+
+    // Closes the diagonal tile: plain Warshall restricted to paths inside k.
+    static void close_diagonal(BitMatrix& graph, const Block& k) {
+        int words = k.last_word - k.first_word;
+        for (int v = k.first; v < k.last; v++) {
+            const uint64_t* row_v = graph.row(v) + k.first_word;
+            uint64_t bit = 1ULL << (v % 64);
+            for (int i = k.first; i < k.last; i++) {
+                uint64_t* row_i = graph.row(i);
+                if (i != v && (row_i[v / 64] & bit))
+                    or_row(row_i + k.first_word, row_v, words);
+            }
+        }
+    }
+
+    // Calls visit(v) for every edge i -> v with v in k.
+    template <typename Visit>
+    static inline void for_each_edge(const uint64_t* row_i, const Block& k, Visit visit) {
+        for (int w = k.first_word; w < k.last_word; w++) {
+            for (uint64_t bits = row_i[w]; bits; bits &= bits - 1)
+                visit(w * 64 + lowest_bit(bits));
+        }
+    }
+
+    // Tile (rows, cols) takes every path that leaves through a vertex of k:
+    // row i ORs in the cols part of row v for each edge i -> v into k. Either
+    // the i -> v bits or the rows v are already closed over k, so the order of
+    // v does not matter and every edge is visited once. The columns go one
+    // cache line at a time, accumulated in registers and stored once.
+    static void update_tile(BitMatrix& graph, const Block& rows, const Block& cols, const Block& k) {
+        for (int i = rows.first; i < rows.last; i++) {
+            uint64_t* row_i = graph.row(i);
+            for (int c = cols.first_word; c < cols.last_word; c += CHUNK_WORDS) {
+                int words = cols.last_word - c;
+                if (words < CHUNK_WORDS) {
+                    for_each_edge(row_i, k, [&](int v) { or_row(row_i + c, graph.row(v) + c, words); });
+                    continue;
+                }
+                bit_packed::vec acc[CHUNK_VECS];
+                for (int l = 0; l < CHUNK_VECS; l++)
+                    acc[l] = bit_packed::vec::load(row_i + c + l * bit_packed::LANES);
+                for_each_edge(row_i, k, [&](int v) {
+                    const uint64_t* row_v = graph.row(v) + c;
+                    for (int l = 0; l < CHUNK_VECS; l++)
+                        acc[l] = acc[l] | bit_packed::vec::load(row_v + l * bit_packed::LANES);
+                });
+                for (int l = 0; l < CHUNK_VECS; l++)
+                    acc[l].store(row_i + c + l * bit_packed::LANES);
+            }
+        }
+    }
+
+    // Every phase is an omp for over its tiles, so the kernel only needs the
+    // OpenMP 2.0 that MSVC's /openmp provides. The phases end in explicit
+    // barriers (the worksharing constructs are nowait) so that a traced run
+    // sees every thread's wait.
+    void transitive_closure_blocked(BitMatrix& graph, int block_size) {
+        int n = graph.n;
+        block_size = std::max(64, (block_size + 63) / 64 * 64);
+        int blocks = (n + block_size - 1) / block_size;
+        int others = blocks - 1;
+#pragma omp parallel
+        for (int kb = 0; kb < blocks; kb++) {
+            CLOSURE_TRACE_SCOPE(BLOCK_STEP, kb);
+            Block k = block_at(kb, block_size, graph);
+#pragma omp single nowait
+            {
+                CLOSURE_TRACE_SCOPE(DIAGONAL, kb);
+                close_diagonal(graph, k);
+            }
+            {
+                CLOSURE_TRACE_SCOPE(WAIT, kb);
+#pragma omp barrier
+            }
+
+            // panels p < others lie in the pivot rows, the rest in the pivot column
+#pragma omp for schedule(dynamic) nowait
+            for (int p = 0; p < 2 * others; p++) {
+                int b = p % others;
+                b += b >= kb ? 1 : 0;
+                CLOSURE_TRACE_SCOPE(PANEL, b);
+                Block other = block_at(b, block_size, graph);
+                if (p < others)
+                    update_tile(graph, k, other, k);
+                else
+                    update_tile(graph, other, k, k);
+            }
+            {
+                CLOSURE_TRACE_SCOPE(WAIT, kb);
+#pragma omp barrier
+            }
+
+#pragma omp for schedule(dynamic) nowait
+            for (int t = 0; t < others * others; t++) {
+                int ib = t / others, jb = t % others;
+                ib += ib >= kb ? 1 : 0;
+                jb += jb >= kb ? 1 : 0;
+                CLOSURE_TRACE_SCOPE(TILE, ib * blocks + jb);
+                update_tile(graph, block_at(ib, block_size, graph), block_at(jb, block_size, graph), k);
+            }
+            {
+                CLOSURE_TRACE_SCOPE(WAIT, kb);
+#pragma omp barrier
+            }
+        }
+    }
+
+    //int main()
+    //{
+    //    const int n = 50000;
+    //    std::vector<int> matrix((size_t)n * n);
+    //    for (size_t x = 0; x < matrix.size(); x++)
+    //        matrix[x] = rand() % 20000 == 0 ? 1 : 0;
+    //    BitMatrix graph = from_matrix(matrix, n);
+    //    double start = omp_get_wtime();
+    //    transitive_closure_blocked(graph);
+    //    double end = omp_get_wtime();
+    //    std::cout << "Execution time: " << (end - start) * 1000 << " ms (" << simd_path() << ")\n";
+    //    return 0;
+    //}
+}
\ No newline at end of file
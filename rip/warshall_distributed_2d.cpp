@@ -0,0 +1,496 @@
+// warshall_distributed_2d.cpp
+// Compile: mpicxx -std=c++17 -O2 -o warshall_distributed_2d warshall_distributed_2d.cpp
+// Run examples:
+//   mpirun -np 4 ./warshall_distributed_2d                          (default 2048 vertices, 64-vertex blocks)
+//   mpirun -np 6 ./warshall_distributed_2d 5000 128 0.0005 7
+//   mpirun -np 4 ./warshall_distributed_2d 300 64 0.01 3 verify
+//                                            (gathers on rank 0 and checks against a serial run)
+//   mpirun -np 4 ./warshall_distributed_2d 20000 64 0.0001 1 out=closure.bin checkpoint=ckpt.bin every=2000
+//   mpirun -np 4 ./warshall_distributed_2d 20000 64 0.0001 1 out=closure.bin checkpoint=ckpt.bin restart
+//                                            (after a failed run: resumes from the step stored in ckpt.bin)
+//   mpirun -np 6 ./warshall_distributed_2d in=graph.bin out=closure.bin
+//                                            (the vertex count comes from the file)
+//
+// Matrix files: a 64-byte header (magic "WSHLBIT1", then n, words per row and
+// the next pivot step as native uint64), followed by n rows of ceil(n / 64)
+// native uint64 words, bit j % 64 of word j / 64 being column j. The next
+// step is 0 for an input graph, n for a finished closure and anything in
+// between for a checkpoint, so any of them can be passed back with in=. Every
+// rank reads and writes only its own blocks, nobody holds the whole matrix.
+
+#include <mpi.h>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace distributed_warshall {
+    // Reproducible edge i -> j, independent of the decomposition, so every rank
+    // can seed its own blocks.
+    int start_value(int i, int j, double prob, uint64_t seed) {
+        uint64_t x = seed ^ ((uint64_t)(uint32_t)i << 32 | (uint32_t)j);
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return (double)(x >> 11) / (double)(1ULL << 53) < prob ? 1 : 0;
+    }
+
+    const char FILE_MAGIC[8] = { 'W', 'S', 'H', 'L', 'B', 'I', 'T', '1' };
+    const MPI_Offset HEADER_BYTES = 64;
+
+    struct FileHeader {
+        char magic[8];
+        uint64_t n;
+        uint64_t words_per_row;
+        uint64_t next_k;
+        uint64_t reserved[4];
+    };
+    static_assert(sizeof(FileHeader) == HEADER_BYTES, "matrix file header must stay 64 bytes");
+
+    // Reads and checks the header of a matrix file; the same result on every rank of comm.
+    bool read_header(const std::string& path, MPI_Comm comm, FileHeader& header) {
+        MPI_File file;
+        if (MPI_File_open(comm, path.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+            return false;
+        bool ok = MPI_File_read_at_all(file, 0, &header, (int)HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+        MPI_Offset size = 0;
+        ok = ok && MPI_File_get_size(file, &size) == MPI_SUCCESS;
+        MPI_File_close(&file);
+        return ok && std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+            && header.n > 0 && header.n <= (uint64_t)INT32_MAX
+            && header.words_per_row == (header.n + 63) / 64 && header.next_k <= header.n
+            && (uint64_t)size >= HEADER_BYTES + header.n * header.words_per_row * sizeof(uint64_t);
+    }
+
+    // One rank's share of a 2D block-cyclic distribution: block_size x
+    // block_size blocks are dealt round robin over a proc_rows x proc_cols
+    // process grid, so every rank holds about n^2 / size bits and the work
+    // stays balanced. Local rows are bit-packed over the local columns.
+    class BlockCyclicMatrix {
+    public:
+        BlockCyclicMatrix(int n, int block_size, MPI_Comm comm) : n(n), block(block_size) {
+            int size;
+            MPI_Comm_size(comm, &size);
+            int dims[2] = { 0, 0 };
+            MPI_Dims_create(size, 2, dims);
+            int periods[2] = { 0, 0 };
+            MPI_Cart_create(comm, 2, dims, periods, 0, &cart);
+            MPI_Comm_rank(cart, &rank);
+            MPI_Cart_coords(cart, rank, 2, coords);
+            proc_rows = dims[0];
+            proc_cols = dims[1];
+            // row_comm links the ranks of one process row, col_comm one column
+            int keep_cols[2] = { 0, 1 }, keep_rows[2] = { 1, 0 };
+            MPI_Cart_sub(cart, keep_cols, &row_comm);
+            MPI_Cart_sub(cart, keep_rows, &col_comm);
+
+            words_per_block = block / 64;
+            for (int i = 0; i < n; i++) {
+                if (row_owner(i) == coords[0])
+                    local_rows.push_back(i);
+            }
+            int blocks = (n + block - 1) / block;
+            for (int b = coords[1]; b < blocks; b += proc_cols)
+                words_per_row += words_per_block;
+            bits.assign((size_t)local_rows.size() * words_per_row, 0);
+        }
+
+        ~BlockCyclicMatrix() {
+            MPI_Comm_free(&row_comm);
+            MPI_Comm_free(&col_comm);
+            MPI_Comm_free(&cart);
+        }
+
+        int get_rank() const { return rank; }
+
+        // Collective: fills this rank's blocks from a matrix file and returns
+        // the step to resume from (0 for a plain matrix), or -1 on error.
+        int read(const std::string& path) {
+            FileHeader header;
+            if (!read_header(path, cart, header) || header.n != (uint64_t)n)
+                return -1;
+            MPI_File file;
+            if (MPI_File_open(cart, path.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+                return -1;
+            std::fill(bits.begin(), bits.end(), 0);
+            bool ok = transfer(file, false);
+            MPI_File_close(&file);
+            return all_ranks(ok) ? (int)header.next_k : -1;
+        }
+
+        // Collective: stores the local blocks together with the step to
+        // resume from. The file is written next to path and renamed over it
+        // once complete, so a crash mid-write leaves the previous one intact.
+        bool write(const std::string& path, int next_k) {
+            std::string partial = path + ".partial";
+            MPI_File file;
+            if (MPI_File_open(cart, partial.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file)
+                != MPI_SUCCESS)
+                return false;
+            bool ok = MPI_File_set_size(file, HEADER_BYTES + (MPI_Offset)n * file_words() * sizeof(uint64_t))
+                == MPI_SUCCESS;
+            if (rank == 0) {
+                FileHeader header = {};
+                std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+                header.n = n;
+                header.words_per_row = file_words();
+                header.next_k = next_k;
+                ok = ok && MPI_File_write_at(file, 0, &header, (int)HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE)
+                    == MPI_SUCCESS;
+            }
+            ok = transfer(file, true) && ok;
+            MPI_File_close(&file);
+            ok = all_ranks(ok);
+            if (ok && rank == 0)
+                ok = std::rename(partial.c_str(), path.c_str()) == 0;
+            MPI_Bcast(&ok, 1, MPI_CXX_BOOL, 0, cart);
+            return ok;
+        }
+
+        void seed(double prob, uint64_t seed) {
+            for (int li = 0; li < (int)local_rows.size(); li++) {
+                for (int j = 0; j < n; j++) {
+                    if (col_owner(j) == coords[1] && start_value(local_rows[li], j, prob, seed))
+                        row(li)[local_word(j)] |= 1ULL << (j % 64);
+                }
+            }
+        }
+
+        // Warshall over the grid. Step k needs row k (from the process row
+        // that owns it, down each process column) and column k (from the
+        // process column that owns it, along each process row), both
+        // bit-packed. Row k + 1 and column k + 1 are brought up to date first
+        // in step k, so their broadcasts are posted before the bulk of step k
+        // and travel while it is computed.
+        //
+        // A run can start at a later step restored from a checkpoint. With
+        // checkpoint_every > 0 the blocks are written to checkpoint_path after
+        // every checkpoint_every steps; they hold the state after that many
+        // complete steps, the early work on the next row and column only
+        // anticipates a later step. Returns false if a checkpoint could not
+        // be written, the closure itself is still completed.
+        bool closure(int first_k = 0, int checkpoint_every = 0, const std::string& checkpoint_path = "") {
+            int local_count = (int)local_rows.size();
+            int column_words = (local_count + 63) / 64;
+            std::vector<uint64_t> row_segment[2], column_segment[2];
+            for (int b = 0; b < 2; b++) {
+                row_segment[b].assign(words_per_row, 0);
+                column_segment[b].assign(column_words, 0);
+            }
+            MPI_Request requests[2][2];
+            if (first_k < n)
+                post_step(first_k, row_segment[first_k % 2], column_segment[first_k % 2], requests[first_k % 2]);
+
+            bool saved = true;
+            for (int k = first_k; k < n; k++) {
+                int b = k % 2;
+                MPI_Waitall(2, requests[b], MPI_STATUSES_IGNORE);
+                const uint64_t* krow = row_segment[b].data();
+                const uint64_t* kcol = column_segment[b].data();
+
+                if (k + 1 < n) {
+                    // only the owners of row/column k + 1 have anything to
+                    // prepare; the one row and one bit per row come first
+                    if (row_owner(k + 1) == coords[0]) {
+                        int li = local_index(k + 1);
+                        if ((kcol[li / 64] >> (li % 64)) & 1)
+                            or_row(row(li), krow);
+                    }
+                    if (col_owner(k + 1) == coords[1] && ((krow[local_word(k + 1)] >> ((k + 1) % 64)) & 1)) {
+                        int word = local_word(k + 1);
+                        uint64_t bit = 1ULL << ((k + 1) % 64);
+                        for (int li = 0; li < local_count; li++) {
+                            if ((kcol[li / 64] >> (li % 64)) & 1)
+                                row(li)[word] |= bit;
+                        }
+                    }
+                    post_step(k + 1, row_segment[1 - b], column_segment[1 - b], requests[1 - b]);
+                }
+
+                for (int li = 0; li < local_count; li++) {
+                    if ((kcol[li / 64] >> (li % 64)) & 1)
+                        or_row(row(li), krow);
+                    // drives the posted broadcasts while this step computes
+                    if (k + 1 < n && li % 256 == 255) {
+                        int done;
+                        MPI_Testall(2, requests[1 - b], &done, MPI_STATUSES_IGNORE);
+                    }
+                }
+
+                if (checkpoint_every > 0 && k + 1 < n && (k + 1) % checkpoint_every == 0)
+                    saved = write(checkpoint_path, k + 1) && saved;
+            }
+            return saved;
+        }
+
+        // Number of set bits over all ranks, on every rank.
+        long long count() const {
+            long long local = 0;
+            for (uint64_t word : bits)
+                local += (long long)std::bitset<64>(word).count();
+            long long total = 0;
+            MPI_Allreduce(&local, &total, 1, MPI_LONG_LONG, MPI_SUM, cart);
+            return total;
+        }
+
+        // Full 0/1 matrix (row-major, n * n) on root, empty elsewhere.
+        std::vector<int> gather(int root) {
+            int size;
+            MPI_Comm_size(cart, &size);
+            int local = (int)bits.size();
+            std::vector<int> counts(size), displs(size);
+            MPI_Gather(&local, 1, MPI_INT, counts.data(), 1, MPI_INT, root, cart);
+            std::vector<uint64_t> all;
+            if (rank == root) {
+                int total = 0;
+                for (int r = 0; r < size; r++) {
+                    displs[r] = total;
+                    total += counts[r];
+                }
+                all.resize(total);
+            }
+            MPI_Gatherv(bits.data(), local, MPI_UINT64_T, all.data(), counts.data(), displs.data(), MPI_UINT64_T,
+                root, cart);
+
+            std::vector<int> matrix;
+            if (rank != root)
+                return matrix;
+            matrix.assign((size_t)n * n, 0);
+            int blocks = (n + block - 1) / block;
+            for (int r = 0; r < size; r++) {
+                int c[2];
+                MPI_Cart_coords(cart, r, 2, c);
+                int r_words = 0;
+                for (int b = c[1]; b < blocks; b += proc_cols)
+                    r_words += words_per_block;
+                int li = 0;
+                for (int i = 0; i < n; i++) {
+                    if (row_owner(i) != c[0])
+                        continue;
+                    const uint64_t* data = all.data() + displs[r] + (size_t)li * r_words;
+                    for (int j = 0; j < n; j++) {
+                        if (col_owner(j) == c[1])
+                            matrix[(size_t)i * n + j] = (int)((data[local_word(j)] >> (j % 64)) & 1);
+                    }
+                    li++;
+                }
+            }
+            return matrix;
+        }
+
+    private:
+        int row_owner(int i) const { return (i / block) % proc_rows; }
+        int col_owner(int j) const { return (j / block) % proc_cols; }
+        // position of a row this rank owns among its local rows
+        int local_index(int i) const { return (i / block / proc_rows) * block + i % block; }
+        // word holding column j in a local row, on the process column owning j
+        int local_word(int j) const { return (j / block / proc_cols) * words_per_block + (j % block) / 64; }
+        uint64_t* row(int li) { return bits.data() + (size_t)li * words_per_row; }
+
+        int file_words() const { return (n + 63) / 64; }
+
+        bool all_ranks(bool ok) {
+            MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_CXX_BOOL, MPI_LAND, cart);
+            return ok;
+        }
+
+        // Moves this rank's blocks between memory and an open matrix file in
+        // one collective call. The file view is the block-cyclic share of the
+        // n x file_words() word array, which is exactly what darray
+        // describes; in memory only the padding words of a partial last
+        // column block are skipped.
+        bool transfer(MPI_File file, bool writing) {
+            int size;
+            MPI_Comm_size(cart, &size);
+            int sizes[2] = { n, file_words() };
+            int distribs[2] = { MPI_DISTRIBUTE_CYCLIC, MPI_DISTRIBUTE_CYCLIC };
+            int dargs[2] = { block, words_per_block };
+            int psizes[2] = { proc_rows, proc_cols };
+            MPI_Datatype file_type;
+            MPI_Type_create_darray(size, rank, 2, sizes, distribs, dargs, psizes, MPI_ORDER_C, MPI_UINT64_T,
+                &file_type);
+            MPI_Type_commit(&file_type);
+
+            int stored_words = 0;
+            for (int w = 0; w < file_words(); w++) {
+                if ((w / words_per_block) % proc_cols == coords[1])
+                    stored_words++;
+            }
+            int local_count = (int)local_rows.size();
+            MPI_Datatype memory_type = MPI_UINT64_T;
+            int count = 0;
+            if (local_count > 0 && stored_words > 0) {
+                int full[2] = { local_count, words_per_row }, part[2] = { local_count, stored_words };
+                int origin[2] = { 0, 0 };
+                MPI_Type_create_subarray(2, full, part, origin, MPI_ORDER_C, MPI_UINT64_T, &memory_type);
+                MPI_Type_commit(&memory_type);
+                count = 1;
+            }
+
+            bool ok = MPI_File_set_view(file, HEADER_BYTES, MPI_UINT64_T, file_type, "native", MPI_INFO_NULL)
+                == MPI_SUCCESS;
+            if (writing)
+                ok = MPI_File_write_all(file, bits.data(), count, memory_type, MPI_STATUS_IGNORE) == MPI_SUCCESS && ok;
+            else
+                ok = MPI_File_read_all(file, bits.data(), count, memory_type, MPI_STATUS_IGNORE) == MPI_SUCCESS && ok;
+            if (count > 0)
+                MPI_Type_free(&memory_type);
+            MPI_Type_free(&file_type);
+            return ok;
+        }
+
+        void or_row(uint64_t* dst, const uint64_t* src) {
+            for (int w = 0; w < words_per_row; w++)
+                dst[w] |= src[w];
+        }
+
+        // Packs this rank's part of row k and column k, if it owns them, and
+        // posts both broadcasts.
+        void post_step(int k, std::vector<uint64_t>& row_segment, std::vector<uint64_t>& column_segment,
+            MPI_Request* requests) {
+            int row_root = row_owner(k), col_root = col_owner(k);
+            if (row_root == coords[0])
+                std::memcpy(row_segment.data(), row(local_index(k)), (size_t)words_per_row * sizeof(uint64_t));
+            if (col_root == coords[1]) {
+                std::fill(column_segment.begin(), column_segment.end(), 0);
+                int word = local_word(k);
+                uint64_t bit = 1ULL << (k % 64);
+                for (int li = 0; li < (int)local_rows.size(); li++) {
+                    if (row(li)[word] & bit)
+                        column_segment[li / 64] |= 1ULL << (li % 64);
+                }
+            }
+            // ranks of col_comm are ordered by process row, of row_comm by process column
+            MPI_Ibcast(row_segment.data(), words_per_row, MPI_UINT64_T, row_root, col_comm, &requests[0]);
+            MPI_Ibcast(column_segment.data(), (int)column_segment.size(), MPI_UINT64_T, col_root, row_comm,
+                &requests[1]);
+        }
+
+        MPI_Comm cart, row_comm, col_comm;
+        int rank;
+        int coords[2];
+        int proc_rows, proc_cols;
+        int n;
+        int block;
+        int words_per_block;
+        int words_per_row = 0;
+        std::vector<int> local_rows;
+        std::vector<uint64_t> bits;
+    };
+
+    std::vector<int> serial_closure(std::vector<int> matrix, int n) {
+        for (int k = 0; k < n; k++)
+            for (int i = 0; i < n; i++)
+                if (matrix[(size_t)i * n + k])
+                    for (int j = 0; j < n; j++)
+                        if (matrix[(size_t)k * n + j])
+                            matrix[(size_t)i * n + j] = 1;
+        return matrix;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int n = 2048, block_size = 64;
+    double prob = 0.001;
+    uint64_t seed = 1;
+    bool verify = false, restart = false;
+    int every = 0;
+    std::string input, output, checkpoint;
+    std::vector<std::string> numbers;
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "verify") verify = true;
+        else if (arg == "restart") restart = true;
+        else if (arg.rfind("in=", 0) == 0) input = arg.substr(3);
+        else if (arg.rfind("out=", 0) == 0) output = arg.substr(4);
+        else if (arg.rfind("checkpoint=", 0) == 0) checkpoint = arg.substr(11);
+        else if (arg.rfind("every=", 0) == 0) every = std::stoi(arg.substr(6));
+        else numbers.push_back(arg);
+    }
+    if (numbers.size() >= 1) n = std::stoi(numbers[0]);
+    if (numbers.size() >= 2) block_size = std::stoi(numbers[1]);
+    if (numbers.size() >= 3) prob = std::stod(numbers[2]);
+    if (numbers.size() >= 4) seed = std::stoull(numbers[3]);
+    // whole words per block keep column blocks from sharing a word
+    block_size = block_size < 64 ? 64 : (block_size + 63) / 64 * 64;
+
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    // a checkpoint is an ordinary matrix file that records how many steps it already contains
+    std::string source = restart ? checkpoint : input;
+    if (!source.empty()) {
+        distributed_warshall::FileHeader header;
+        if (!distributed_warshall::read_header(source, MPI_COMM_WORLD, header)) {
+            if (world_rank == 0)
+                std::cerr << "Cannot read matrix file " << source << "\n";
+            MPI_Finalize();
+            return 1;
+        }
+        n = (int)header.n;
+    }
+
+    int result = 0;
+    {
+        distributed_warshall::BlockCyclicMatrix matrix(n, block_size, MPI_COMM_WORLD);
+        int rank = matrix.get_rank();
+        int first_k = 0;
+        if (source.empty())
+            matrix.seed(prob, seed);
+        else
+            first_k = matrix.read(source);
+
+        // verification is for small runs only: it gathers whole matrices on rank 0.
+        // Every intermediate state has the same closure, so a checkpoint works as start.
+        std::vector<int> start;
+        if (verify && first_k >= 0)
+            start = matrix.gather(0);
+
+        bool saved = true;
+        double duration = 0;
+        if (first_k >= 0) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            double t_start = MPI_Wtime();
+            saved = matrix.closure(first_k, checkpoint.empty() ? 0 : every, checkpoint);
+            MPI_Barrier(MPI_COMM_WORLD);
+            duration = (MPI_Wtime() - t_start) * 1000;
+        }
+        bool written = first_k >= 0 && (output.empty() || matrix.write(output, n));
+        long long reachable = first_k >= 0 ? matrix.count() : 0;
+
+        if (rank == 0) {
+            if (first_k < 0) {
+                std::cerr << "Cannot read matrix file " << source << "\n";
+                result = 1;
+            }
+            else {
+                if (first_k > 0)
+                    std::cout << "Resumed at step " << first_k << " of " << n << ".\n";
+                std::cout << "Reachable pairs: " << reachable << "\n";
+                std::cout << "Warshall algorithm completed in " << duration << " miliseconds.\n";
+                if (!saved)
+                    std::cerr << "Writing checkpoint " << checkpoint << " failed.\n";
+                if (!written) {
+                    std::cerr << "Writing " << output << " failed.\n";
+                    result = 1;
+                }
+            }
+        }
+        std::vector<int> closure = verify && first_k >= 0 ? matrix.gather(0) : std::vector<int>();
+        if (rank == 0 && verify && first_k >= 0) {
+            bool same = distributed_warshall::serial_closure(start, n) == closure;
+            std::cout << (same ? "Verified against serial run.\n" : "MISMATCH against serial run.\n");
+            result = same ? result : 1;
+        }
+        MPI_Bcast(&result, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    }
+
+    MPI_Finalize();
+    return result;
+}
\ No newline at end of file
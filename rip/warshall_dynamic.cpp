@@ -0,0 +1,144 @@
+#include "warshall.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstring>
+
+namespace dynamic_closure {
+    DynamicClosure::DynamicClosure(int n, double rebuild_fraction)
+        : n(n), rebuild_fraction(rebuild_fraction), edges(n), reach(n) {
+    }
+
+    DynamicClosure::DynamicClosure(const bit_warshall::BitMatrix& edges, double rebuild_fraction)
+        : n(edges.n), rebuild_fraction(rebuild_fraction), edges(edges), reach(edges.n) {
+        rebuild();
+    }
+
+    void DynamicClosure::rebuild() {
+        reach = edges;
+        bit_warshall::transitive_closure_blocked(reach);
+        rebuilds++;
+    }
+
+    // Every new path runs x -> .. -> from -> to -> ..., so each x that is from
+    // or reaches it gains to and all of row to.
+    void DynamicClosure::close_insertion(int from, int to) {
+        if (reach.get(from, to))
+            return;
+        int stride = reach.stride;
+        std::vector<uint64_t, bit_warshall::CacheAlignedAllocator<uint64_t>> gained(reach.row(to),
+            reach.row(to) + stride);
+        gained[to / 64] |= 1ULL << (to % 64);
+        const uint64_t* source = gained.data();
+#pragma omp parallel for schedule(static)
+        for (int x = 0; x < n; x++) {
+            if (x == from || reach.get(x, from))
+                bit_warshall::or_row(reach.row(x), source, stride);
+        }
+    }
+
+    // Rows of unaffected vertices are exact and never change here, so every
+    // affected row can be rebuilt on its own: search the edges from x, and at
+    // an unaffected vertex take its row instead of going further (all it
+    // reaches is unaffected too).
+    void DynamicClosure::recompute_rows(const std::vector<char>& affected, const std::vector<int>& rows) {
+        int stride = reach.stride;
+#pragma omp parallel
+        {
+            std::vector<int> stack;
+#pragma omp for schedule(dynamic, 4)
+            for (int r = 0; r < (int)rows.size(); r++) {
+                int x = rows[r];
+                uint64_t* row = reach.row(x);
+                std::memset(row, 0, (size_t)stride * sizeof(uint64_t));
+                stack.assign(1, x);
+                while (!stack.empty()) {
+                    int v = stack.back();
+                    stack.pop_back();
+                    const uint64_t* out = edges.row(v);
+                    for (int w = 0; w < stride; w++) {
+                        for (uint64_t fresh = out[w] & ~row[w]; fresh; fresh &= fresh - 1) {
+                            int t = w * 64 + bit_warshall::lowest_bit(fresh);
+                            if (row[w] >> (t % 64) & 1)
+                                continue;
+                            row[w] |= 1ULL << (t % 64);
+                            if (affected[t])
+                                stack.push_back(t);
+                            else
+                                bit_warshall::or_row(row, reach.row(t), stride);
+                        }
+                    }
+                }
+            }
+        }
+        recomputed += (long long)rows.size();
+    }
+
+    void DynamicClosure::apply(const std::vector<Update>& batch) {
+        // net effect of the batch: compare every touched edge before and after
+        std::vector<char> before(batch.size());
+        for (size_t u = 0; u < batch.size(); u++)
+            before[u] = edges.get(batch[u].from, batch[u].to);
+        for (const Update& update : batch) {
+            if (update.insert)
+                edges.set(update.from, update.to);
+            else
+                edges.clear(update.from, update.to);
+        }
+        std::vector<int> removed_sources;
+        std::vector<Update> inserted;
+        for (size_t u = 0; u < batch.size(); u++) {
+            bool after = edges.get(batch[u].from, batch[u].to);
+            if (before[u] && !after)
+                removed_sources.push_back(batch[u].from);
+            else if (!before[u] && after)
+                inserted.push_back(batch[u]);
+        }
+
+        if (!removed_sources.empty()) {
+            // only rows that reached the source of a removed edge can shrink
+            std::vector<char> affected(n, 0);
+#pragma omp parallel for schedule(static)
+            for (int x = 0; x < n; x++) {
+                for (int source : removed_sources) {
+                    if (x == source || reach.get(x, source)) {
+                        affected[x] = 1;
+                        break;
+                    }
+                }
+            }
+            std::vector<int> rows;
+            for (int x = 0; x < n; x++) {
+                if (affected[x])
+                    rows.push_back(x);
+            }
+            if ((double)rows.size() > rebuild_fraction * n) {
+                rebuild();
+                return;
+            }
+            recompute_rows(affected, rows);
+        }
+        for (const Update& update : inserted)
+            close_insertion(update.from, update.to);
+    }
+
+    //int main()
+    //{
+    //    const int n = 20000;
+    //    DynamicClosure closure(n);
+    //    std::vector<Update> batch;
+    //    for (int e = 0; e < 2 * n; e++)
+    //        batch.push_back({ rand() % n, rand() % n, true });
+    //    closure.apply(batch);
+    //    double start = omp_get_wtime();
+    //    for (int round = 0; round < 100; round++) {
+    //        batch.clear();
+    //        for (int e = 0; e < 16; e++)
+    //            batch.push_back({ rand() % n, rand() % n, rand() % 2 == 0 });
+    //        closure.apply(batch);
+    //    }
+    //    double end = omp_get_wtime();
+    //    std::cout << "Execution time: " << (end - start) * 1000 << " ms, " << closure.rows_recomputed()
+    //        << " rows recomputed, " << closure.full_rebuilds() << " full rebuilds\n";
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#include "warshall.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace opencl_closure {
+    // Row i of the matrix is words = padded / 32 uints, bit j % 32 of uint
+    // j / 32 being the edge i -> j. A block is BLOCK rows of BW uints; every
+    // work-group handles one block with one work-item per uint and keeps the
+    // blocks it reads in __local memory for the whole pivot loop. Within a
+    // round the pivot rows and the pivot column do not change (their update
+    // is with the diagonal bit), but a work-item may be reading a word that
+    // another one is rewriting, so the sequential phases read, wait, write
+    // and wait for every pivot.
+    const char* kernelSource = R"(
+__kernel void diagonal(__global uint* m, const int words, const int kb) {
+    __local uint tile[BLOCK][BW];
+    const int w = get_local_id(0);
+    const int r = get_local_id(1);
+    const size_t at = (size_t)(kb * BLOCK + r) * words + kb * BW + w;
+    tile[r][w] = m[at];
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int k = 0; k < BLOCK; k++) {
+        uint has = (tile[r][k / 32] >> (k % 32)) & 1;
+        uint pivot = tile[k][w];
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (has)
+            tile[r][w] |= pivot;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    m[at] = tile[r][w];
+}
+
+// Group g < blocks - 1 is a block of the pivot rows, which takes pivot rows
+// of itself wherever the closed diagonal block has the bit; the others are
+// blocks of the pivot column, which take rows of the diagonal block wherever
+// they have the bit themselves.
+__kernel void panels(__global uint* m, const int words, const int kb, const int blocks) {
+    __local uint diag[BLOCK][BW];
+    __local uint panel[BLOCK][BW];
+    const int w = get_local_id(0);
+    const int r = get_local_id(1);
+    const int g = get_group_id(0);
+    const int in_row = g < blocks - 1;
+    const int other = in_row ? g : g - (blocks - 1);
+    const int b = other < kb ? other : other + 1;
+    const int ib = in_row ? kb : b;
+    const int jb = in_row ? b : kb;
+    const size_t at = (size_t)(ib * BLOCK + r) * words + jb * BW + w;
+    diag[r][w] = m[(size_t)(kb * BLOCK + r) * words + kb * BW + w];
+    panel[r][w] = m[at];
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int k = 0; k < BLOCK; k++) {
+        uint has = ((in_row ? diag[r][k / 32] : panel[r][k / 32]) >> (k % 32)) & 1;
+        uint pivot = in_row ? panel[k][w] : diag[k][w];
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (has)
+            panel[r][w] |= pivot;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    m[at] = panel[r][w];
+}
+
+// Every block outside the pivot rows and column only reads the two closed
+// panels, so all of them run at once and need no barrier in the pivot loop.
+__kernel void remaining(__global uint* m, const int words, const int kb) {
+    __local uint column[BLOCK][BW];
+    __local uint row[BLOCK][BW];
+    const int w = get_local_id(0);
+    const int r = get_local_id(1);
+    const int jb = get_group_id(0) < kb ? get_group_id(0) : get_group_id(0) + 1;
+    const int ib = get_group_id(1) < kb ? get_group_id(1) : get_group_id(1) + 1;
+    column[r][w] = m[(size_t)(ib * BLOCK + r) * words + kb * BW + w];
+    row[r][w] = m[(size_t)(kb * BLOCK + r) * words + jb * BW + w];
+    barrier(CLK_LOCAL_MEM_FENCE);
+    const size_t at = (size_t)(ib * BLOCK + r) * words + jb * BW + w;
+    uint result = m[at];
+    for (int cw = 0; cw < BW; cw++) {
+        uint bits = column[r][cw];
+        if (bits == 0)
+            continue;
+        for (int b = 0; b < 32; b++)
+            result |= row[cw * 32 + b][w] & (0u - ((bits >> b) & 1));
+    }
+    m[at] = result;
+}
+)";
+
+    struct OpenCLClosure::Handles {
+        cl_device_id device = NULL;
+        cl_context context = NULL;
+        cl_command_queue queue = NULL;
+        cl_program program = NULL;
+        cl_kernel diagonal = NULL;
+        cl_kernel panels = NULL;
+        cl_kernel remaining = NULL;
+        cl_mem matrix = NULL;
+    };
+
+    static void check(cl_int err, const char* what) {
+        if (err != CL_SUCCESS)
+            throw std::runtime_error(std::string(what) + " failed with OpenCL error " + std::to_string(err));
+    }
+
+    // First device of the requested type on any platform.
+    static bool find_device(cl_device_type type, cl_device_id& device) {
+        cl_uint platform_count = 0;
+        if (clGetPlatformIDs(0, NULL, &platform_count) != CL_SUCCESS || platform_count == 0)
+            return false;
+        std::vector<cl_platform_id> platforms(platform_count);
+        clGetPlatformIDs(platform_count, platforms.data(), NULL);
+        for (cl_platform_id platform : platforms) {
+            if (clGetDeviceIDs(platform, type, 1, &device, NULL) == CL_SUCCESS)
+                return true;
+        }
+        return false;
+    }
+
+    // Builds the kernels for the current block size. Returns false, with
+    // nothing left built, if one of them cannot run groups of the given size
+    // (a kernel's limit can be below the device's, e.g. for its __local use).
+    bool OpenCLClosure::build_kernels(size_t group) {
+        cl_int err;
+        cl->program = clCreateProgramWithSource(cl->context, 1, &kernelSource, NULL, &err);
+        check(err, "clCreateProgramWithSource");
+        std::string options = "-D BLOCK=" + std::to_string(block) + " -D BW=" + std::to_string(block / 32);
+        err = clBuildProgram(cl->program, 1, &cl->device, options.c_str(), NULL, NULL);
+        if (err != CL_SUCCESS) {
+            size_t log_size = 0;
+            clGetProgramBuildInfo(cl->program, cl->device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+            std::string log(log_size, '\0');
+            clGetProgramBuildInfo(cl->program, cl->device, CL_PROGRAM_BUILD_LOG, log_size, &log[0], NULL);
+            throw std::runtime_error("clBuildProgram failed: " + log);
+        }
+        cl->diagonal = clCreateKernel(cl->program, "diagonal", &err);
+        check(err, "clCreateKernel");
+        cl->panels = clCreateKernel(cl->program, "panels", &err);
+        check(err, "clCreateKernel");
+        cl->remaining = clCreateKernel(cl->program, "remaining", &err);
+        check(err, "clCreateKernel");
+
+        bool fits = true;
+        for (cl_kernel kernel : { cl->diagonal, cl->panels, cl->remaining }) {
+            size_t limit = 0;
+            check(clGetKernelWorkGroupInfo(kernel, cl->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(limit), &limit, NULL),
+                "clGetKernelWorkGroupInfo");
+            fits = fits && group <= limit;
+        }
+        if (fits)
+            return true;
+        for (cl_kernel* kernel : { &cl->diagonal, &cl->panels, &cl->remaining }) {
+            clReleaseKernel(*kernel);
+            *kernel = NULL;
+        }
+        clReleaseProgram(cl->program);
+        cl->program = NULL;
+        return false;
+    }
+
+    OpenCLClosure::OpenCLClosure(int n) : cl(new Handles()), n(n) {
+        try {
+            if (!find_device(CL_DEVICE_TYPE_GPU, cl->device) && !find_device(CL_DEVICE_TYPE_CPU, cl->device))
+                throw std::runtime_error("no OpenCL GPU or CPU device found");
+
+            char name[256] = { 0 };
+            clGetDeviceInfo(cl->device, CL_DEVICE_NAME, sizeof(name) - 1, name, NULL);
+            device = name;
+
+            cl_int err;
+            cl->context = clCreateContext(NULL, 1, &cl->device, NULL, NULL, &err);
+            check(err, "clCreateContext");
+            cl->queue = clCreateCommandQueue(cl->context, cl->device, 0, &err);
+            check(err, "clCreateCommandQueue");
+
+            // a work-group is one block with a work-item per uint, (BW, BLOCK)
+            // = (4, 128), (2, 64) or (1, 32); the largest block whose group
+            // fits the device and, once built, every kernel's own limit wins
+            size_t max_group = 0;
+            check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_group), &max_group, NULL), "clGetDeviceInfo");
+            cl_uint dimensions = 0;
+            check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(dimensions), &dimensions, NULL), "clGetDeviceInfo");
+            std::vector<size_t> max_items(std::max<cl_uint>(dimensions, 2));
+            check(clGetDeviceInfo(cl->device, CL_DEVICE_MAX_WORK_ITEM_SIZES, dimensions * sizeof(size_t), max_items.data(), NULL), "clGetDeviceInfo");
+            for (block = 128; block >= 32; block /= 2) {
+                size_t group = (size_t)block * block / 32;
+                if (group > max_group || (size_t)block / 32 > max_items[0] || (size_t)block > max_items[1])
+                    continue;
+                if (build_kernels(group))
+                    break;
+            }
+            if (block < 32)
+                throw std::runtime_error("OpenCL device work-groups are too small for 32 x 32 blocks");
+            padded = std::max(block, (n + block - 1) / block * block);
+
+            cl->matrix = clCreateBuffer(cl->context, CL_MEM_READ_WRITE, (size_t)padded * padded / 8, NULL, &err);
+            check(err, "clCreateBuffer");
+            cl_int words = padded / 32;
+            cl_int blocks = padded / block;
+            for (cl_kernel kernel : { cl->diagonal, cl->panels, cl->remaining }) {
+                check(clSetKernelArg(kernel, 0, sizeof(cl_mem), &cl->matrix), "clSetKernelArg");
+                check(clSetKernelArg(kernel, 1, sizeof(cl_int), &words), "clSetKernelArg");
+            }
+            check(clSetKernelArg(cl->panels, 3, sizeof(cl_int), &blocks), "clSetKernelArg");
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    OpenCLClosure::~OpenCLClosure() {
+        release();
+    }
+
+    void OpenCLClosure::release() {
+        if (cl == NULL)
+            return;
+        if (cl->queue)
+            clFinish(cl->queue);
+        if (cl->matrix)
+            clReleaseMemObject(cl->matrix);
+        for (cl_kernel kernel : { cl->diagonal, cl->panels, cl->remaining })
+            if (kernel)
+                clReleaseKernel(kernel);
+        if (cl->program)
+            clReleaseProgram(cl->program);
+        if (cl->queue)
+            clReleaseCommandQueue(cl->queue);
+        if (cl->context)
+            clReleaseContext(cl->context);
+        delete cl;
+        cl = NULL;
+    }
+
+    void OpenCLClosure::load_matrix(const bit_warshall::BitMatrix& graph) {
+        if (graph.n != n)
+            throw std::invalid_argument("OpenCLClosure::load_matrix: matrix size differs from the constructor's");
+        int words = padded / 32;
+        std::vector<cl_uint> bits((size_t)padded * words, 0);
+        for (int i = 0; i < n; i++) {
+            const uint64_t* row = graph.row(i);
+            cl_uint* out = bits.data() + (size_t)i * words;
+            for (int w = 0; w < (n + 63) / 64; w++) {
+                out[2 * w] = (cl_uint)row[w];
+                if (2 * w + 1 < words)
+                    out[2 * w + 1] = (cl_uint)(row[w] >> 32);
+            }
+        }
+        check(clEnqueueWriteBuffer(cl->queue, cl->matrix, CL_TRUE, 0, bits.size() * sizeof(cl_uint), bits.data(), 0,
+            NULL, NULL), "clEnqueueWriteBuffer");
+    }
+
+    void OpenCLClosure::closure() {
+        cl_int blocks = padded / block;
+        size_t local_size[2] = { (size_t)block / 32, (size_t)block };
+        size_t panel_size[2] = { 2 * (size_t)(blocks - 1) * local_size[0], local_size[1] };
+        size_t rest_size[2] = { (size_t)(blocks - 1) * local_size[0], (size_t)(blocks - 1) * local_size[1] };
+        for (cl_int kb = 0; kb < blocks; kb++) {
+            // arguments are captured at enqueue time and the queue runs the
+            // launches in order, so the rounds chain without waiting
+            check(clSetKernelArg(cl->diagonal, 2, sizeof(cl_int), &kb), "clSetKernelArg");
+            check(clEnqueueNDRangeKernel(cl->queue, cl->diagonal, 2, NULL, local_size, local_size, 0, NULL, NULL),
+                "clEnqueueNDRangeKernel");
+            if (blocks == 1)
+                continue;
+            check(clSetKernelArg(cl->panels, 2, sizeof(cl_int), &kb), "clSetKernelArg");
+            check(clEnqueueNDRangeKernel(cl->queue, cl->panels, 2, NULL, panel_size, local_size, 0, NULL, NULL),
+                "clEnqueueNDRangeKernel");
+            check(clSetKernelArg(cl->remaining, 2, sizeof(cl_int), &kb), "clSetKernelArg");
+            check(clEnqueueNDRangeKernel(cl->queue, cl->remaining, 2, NULL, rest_size, local_size, 0, NULL, NULL),
+                "clEnqueueNDRangeKernel");
+        }
+        check(clFlush(cl->queue), "clFlush");
+    }
+
+    bit_warshall::BitMatrix OpenCLClosure::snapshot() {
+        int words = padded / 32;
+        std::vector<cl_uint> bits((size_t)padded * words);
+        check(clEnqueueReadBuffer(cl->queue, cl->matrix, CL_TRUE, 0, bits.size() * sizeof(cl_uint), bits.data(), 0,
+            NULL, NULL), "clEnqueueReadBuffer");
+        bit_warshall::BitMatrix graph(n);
+        for (int i = 0; i < n; i++) {
+            const cl_uint* in = bits.data() + (size_t)i * words;
+            uint64_t* row = graph.row(i);
+            for (int w = 0; w < (n + 63) / 64; w++) {
+                row[w] = in[2 * w];
+                if (2 * w + 1 < words)
+                    row[w] |= (uint64_t)in[2 * w + 1] << 32;
+            }
+        }
+        return graph;
+    }
+
+    //int main()
+    //{
+    //    int n = 8192;
+    //    bit_warshall::BitMatrix graph(n);
+    //    for (int i = 0; i < n; i++)
+    //        for (int j = 0; j < n; j++)
+    //            if (rand() % 2000 == 0)
+    //                graph.set(i, j);
+    //    OpenCLClosure gpu(n);
+    //    gpu.load_matrix(graph);
+    //    std::cout << "Device: " << gpu.device_name() << ", " << gpu.block_size() << "-bit blocks" << std::endl;
+    //    auto start = std::chrono::high_resolution_clock::now();
+    //    gpu.closure();
+    //    bit_warshall::BitMatrix result = gpu.snapshot();
+    //    auto stop = std::chrono::high_resolution_clock::now();
+    //    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    //    std::cout << "Time elapsed: " << duration.count() << " ms" << std::endl;
+    //
+    //    // The same closure on the host, word for word
+    //    start = std::chrono::high_resolution_clock::now();
+    //    bit_warshall::transitive_closure(graph);
+    //    stop = std::chrono::high_resolution_clock::now();
+    //    duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    //    std::cout << "Host bit_warshall: " << duration.count() << " ms" << std::endl;
+    //    for (int i = 0; i < n; i++)
+    //        if (!std::equal(result.row(i), result.row(i) + (n + 63) / 64, graph.row(i))) {
+    //            std::cout << "Mismatch in row " << i << std::endl;
+    //            return 1;
+    //        }
+    //    std::cout << "Matches bit_warshall::transitive_closure" << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "warshall.h"
+#include <omp.h>
+#include <algorithm>
+
+namespace scc_closure {
+    CsrGraph from_edges(int n, const std::vector<std::pair<int, int>>& edges) {
+        CsrGraph graph;
+        graph.n = n;
+        graph.offsets.assign((size_t)n + 1, 0);
+        for (const auto& edge : edges)
+            graph.offsets[edge.first + 1]++;
+        for (int u = 0; u < n; u++)
+            graph.offsets[u + 1] += graph.offsets[u];
+        graph.targets.resize(edges.size());
+        std::vector<int64_t> next(graph.offsets.begin(), graph.offsets.end() - 1);
+        for (const auto& edge : edges)
+            graph.targets[next[edge.first]++] = edge.second;
+        return graph;
+    }
+
+    CsrGraph from_matrix(const std::vector<int>& matrix, int n) {
+        std::vector<std::pair<int, int>> edges;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (matrix[(size_t)i * n + j])
+                    edges.push_back({ i, j });
+            }
+        }
+        return from_edges(n, edges);
+    }
+
+    // Tarjan's algorithm with an explicit call stack, so graphs with paths of
+    // millions of vertices do not overflow the thread stack.
+    static int strong_components(const CsrGraph& graph, std::vector<int>& component) {
+        struct Frame {
+            int vertex;
+            int64_t edge;
+        };
+        int n = graph.n;
+        std::vector<int> index(n, -1), low(n, 0);
+        std::vector<char> on_stack(n, 0);
+        std::vector<int> stack;
+        std::vector<Frame> calls;
+        component.assign(n, -1);
+        int counter = 0;
+        int components = 0;
+        for (int root = 0; root < n; root++) {
+            if (index[root] >= 0)
+                continue;
+            index[root] = low[root] = counter++;
+            stack.push_back(root);
+            on_stack[root] = 1;
+            calls.push_back({ root, graph.offsets[root] });
+            while (!calls.empty()) {
+                Frame& frame = calls.back();
+                int v = frame.vertex;
+                if (frame.edge < graph.offsets[v + 1]) {
+                    int w = graph.targets[frame.edge++];
+                    if (index[w] < 0) {
+                        index[w] = low[w] = counter++;
+                        stack.push_back(w);
+                        on_stack[w] = 1;
+                        calls.push_back({ w, graph.offsets[w] });
+                    }
+                    else if (on_stack[w]) {
+                        low[v] = std::min(low[v], index[w]);
+                    }
+                    continue;
+                }
+                calls.pop_back();
+                if (!calls.empty())
+                    low[calls.back().vertex] = std::min(low[calls.back().vertex], low[v]);
+                if (low[v] != index[v])
+                    continue;
+                int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = 0;
+                    component[w] = components;
+                } while (w != v);
+                components++;
+            }
+        }
+        return components;
+    }
+
+    Condensation condense(const CsrGraph& graph) {
+        Condensation result;
+        int n = graph.n;
+        int components = strong_components(graph, result.component);
+        result.components = components;
+
+        // members of every component, grouped by a counting sort
+        std::vector<int64_t> first((size_t)components + 1, 0);
+        for (int u = 0; u < n; u++)
+            first[result.component[u] + 1]++;
+        for (int c = 0; c < components; c++)
+            first[c + 1] += first[c];
+        std::vector<int> members(n);
+        std::vector<int64_t> next(first.begin(), first.end() - 1);
+        for (int u = 0; u < n; u++)
+            members[next[result.component[u]]++] = u;
+
+        result.cyclic.assign(components, 0);
+        std::vector<std::vector<int>> successors(components);
+#pragma omp parallel for schedule(dynamic, 256)
+        for (int c = 0; c < components; c++) {
+            std::vector<int>& out = successors[c];
+            result.cyclic[c] = first[c + 1] - first[c] > 1;
+            for (int64_t m = first[c]; m < first[c + 1]; m++) {
+                int u = members[m];
+                for (int64_t e = graph.offsets[u]; e < graph.offsets[u + 1]; e++) {
+                    int d = result.component[graph.targets[e]];
+                    if (d != c)
+                        out.push_back(d);
+                    else if (graph.targets[e] == u)
+                        result.cyclic[c] = 1;
+                }
+            }
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        }
+
+        CsrGraph& dag = result.dag;
+        dag.n = components;
+        dag.offsets.assign((size_t)components + 1, 0);
+        for (int c = 0; c < components; c++)
+            dag.offsets[c + 1] = dag.offsets[c] + (int64_t)successors[c].size();
+        dag.targets.resize(dag.offsets[components]);
+#pragma omp parallel for schedule(dynamic, 256)
+        for (int c = 0; c < components; c++)
+            std::copy(successors[c].begin(), successors[c].end(), dag.targets.begin() + dag.offsets[c]);
+
+        // successors have lower numbers, so one pass in number order sees them first
+        result.level.assign(components, 0);
+        for (int c = 0; c < components; c++) {
+            for (int64_t e = dag.offsets[c]; e < dag.offsets[c + 1]; e++)
+                result.level[c] = std::max(result.level[c], result.level[dag.targets[e]] + 1);
+        }
+        return result;
+    }
+
+    Closure transitive_closure(const CsrGraph& graph) {
+        Condensation condensation = condense(graph);
+        int components = condensation.components;
+        const CsrGraph& dag = condensation.dag;
+
+        int levels = 0;
+        for (int level : condensation.level)
+            levels = std::max(levels, level + 1);
+        std::vector<int64_t> first((size_t)levels + 1, 0);
+        for (int level : condensation.level)
+            first[level + 1]++;
+        for (int l = 0; l < levels; l++)
+            first[l + 1] += first[l];
+        std::vector<int> by_level(components);
+        std::vector<int64_t> next(first.begin(), first.end() - 1);
+        for (int c = 0; c < components; c++)
+            by_level[next[condensation.level[c]]++] = c;
+
+        Closure closure;
+        closure.component = std::move(condensation.component);
+        closure.reach = bit_warshall::BitMatrix(components);
+        bit_warshall::BitMatrix& reach = closure.reach;
+        for (int l = 0; l < levels; l++) {
+            int begin = (int)first[l], end = (int)first[l + 1];
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int x = begin; x < end; x++) {
+                int c = by_level[x];
+                uint64_t* row = reach.row(c);
+                if (condensation.cyclic[c])
+                    reach.set(c, c);
+                // a successor d has a lower number and so does everything it
+                // reaches, so row d is zero past word d / 64
+                for (int64_t e = dag.offsets[c]; e < dag.offsets[c + 1]; e++) {
+                    int d = dag.targets[e];
+                    reach.set(c, d);
+                    bit_warshall::or_row(row, reach.row(d), d / 64 + 1);
+                }
+            }
+        }
+        return closure;
+    }
+
+    std::vector<int> to_matrix(const Closure& closure) {
+        int n = (int)closure.component.size();
+        std::vector<int> matrix((size_t)n * n);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++)
+                matrix[(size_t)i * n + j] = closure.reaches(i, j) ? 1 : 0;
+        }
+        return matrix;
+    }
+
+    //int main()
+    //{
+    //    const int n = 1000000;
+    //    std::vector<std::pair<int, int>> edges;
+    //    for (int e = 0; e < 8 * n; e++)
+    //        edges.push_back({ rand() % n, rand() % n });
+    //    CsrGraph graph = from_edges(n, edges);
+    //    double start = omp_get_wtime();
+    //    Condensation condensation = condense(graph);
+    //    double end = omp_get_wtime();
+    //    std::cout << condensation.components << " components, condensed in " << (end - start) * 1000 << " ms\n";
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "warshall_semiring.h"
+
+namespace semiring_paths {
+    std::vector<int> path(const Predecessors& pred, int from, int to) {
+        if (from == to)
+            return { from };
+        std::vector<int> vertices = { to };
+        for (int v = to; v != from;) {
+            v = pred.at(from, v);
+            // no path, or a predecessor chain broken by a negative cycle
+            if (v < 0 || (int)vertices.size() > pred.n)
+                return {};
+            vertices.push_back(v);
+        }
+        std::reverse(vertices.begin(), vertices.end());
+        return vertices;
+    }
+
+    //int main()
+    //{
+    //    const int n = 2000;
+    //    MinPlus<int32_t>::Matrix distance = make_matrix<MinPlus<int32_t>>(n);
+    //    for (int e = 0; e < 8 * n; e++)
+    //        distance.at(rand() % n, rand() % n) = 1 + rand() % 100;
+    //    Predecessors pred;
+    //    double start = omp_get_wtime();
+    //    closure<MinPlus<int32_t>>(distance, pred);
+    //    double end = omp_get_wtime();
+    //    std::cout << "Execution time: " << (end - start) * 1000 << " ms (" << WEIGHT_SIMD_PATH << ")\n";
+    //    for (int v : path(pred, 0, n - 1))
+    //        std::cout << v << " ";
+    //    std::cout << std::endl;
+    //    return 0;
+    //}
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#pragma once
+#include "warshall.h"
+#include <immintrin.h>
+#include <omp.h>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+// Warshall over a closed semiring. The update
+//     a[i][j] = plus(a[i][j], times(a[i][k], a[k][j]))
+// is Boolean closure for (or, and), shortest paths for (min, +) and widest
+// (bottleneck) paths for (max, min). Every semiring is a type that brings its
+// matrix layout and its own SIMD row update, so closure<S>() compiles to a
+// separate kernel per semiring with nothing dispatched inside the loops. The
+// Boolean semiring runs on BitMatrix and its row update is the word OR of
+// bit_warshall, so it costs the same as the hand-written closure.
+
+namespace semiring_paths {
+    // Row-major n x n weights. Rows start on a cache line and are padded to
+    // whole cache lines, a multiple of any SIMD width, so row updates need no
+    // tail loop; padding holds the value the matrix was created with.
+    template <typename T>
+    struct WeightMatrix {
+        int n = 0;
+        int stride = 0;
+        std::vector<T, bit_warshall::CacheAlignedAllocator<T>> values;
+
+        WeightMatrix() = default;
+        WeightMatrix(int n, T fill)
+            : n(n), stride(padded(n)), values((size_t)n * padded(n), fill) {
+        }
+
+        T* row(int i) { return values.data() + (size_t)i * stride; }
+        const T* row(int i) const { return values.data() + (size_t)i * stride; }
+        T& at(int i, int j) { return row(i)[j]; }
+        T at(int i, int j) const { return row(i)[j]; }
+
+    private:
+        static int padded(int n) {
+            const int per_line = bit_warshall::CACHE_LINE / (int)sizeof(T);
+            return (n + per_line - 1) / per_line * per_line;
+        }
+    };
+
+    // Predecessor matrix of a closure with path tracking: at(i, j) is the
+    // vertex before j on the best path from i to j, -1 when there is none.
+    using Predecessors = WeightMatrix<int32_t>;
+
+    // SIMD registers of T (and of int32 predecessors, same lane count) for the
+    // widest instruction set the build targets.
+    template <typename T>
+    struct lanes;
+
+#if defined(__AVX512F__)
+    template <>
+    struct lanes<int32_t> {
+        using reg = __m512i;
+        static constexpr int WIDTH = 16;
+        static reg load(const int32_t* p) { return _mm512_loadu_si512(p); }
+        static void store(int32_t* p, reg v) { _mm512_storeu_si512(p, v); }
+        static reg splat(int32_t x) { return _mm512_set1_epi32(x); }
+        static reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+        static reg min(reg a, reg b) { return _mm512_min_epi32(a, b); }
+        static reg max(reg a, reg b) { return _mm512_max_epi32(a, b); }
+        // x where value != sentinel, sentinel elsewhere
+        static reg keep_sentinel(reg x, reg value, reg sentinel) {
+            return _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(value, sentinel), x, sentinel);
+        }
+        // changed where now != before, kept elsewhere
+        static __m512i select_changed(reg now, reg before, __m512i changed, __m512i kept) {
+            return _mm512_mask_blend_epi32(_mm512_cmpneq_epi32_mask(now, before), kept, changed);
+        }
+    };
+
+    template <>
+    struct lanes<float> {
+        using reg = __m512;
+        static constexpr int WIDTH = 16;
+        static reg load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+        static reg splat(float x) { return _mm512_set1_ps(x); }
+        static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+        static reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+        static reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+        static __m512i select_changed(reg now, reg before, __m512i changed, __m512i kept) {
+            return _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(now, before, _CMP_NEQ_UQ), kept, changed);
+        }
+    };
+
+    inline __m512i load_index(const int32_t* p) { return _mm512_loadu_si512(p); }
+    inline void store_index(int32_t* p, __m512i v) { _mm512_storeu_si512(p, v); }
+    constexpr const char* WEIGHT_SIMD_PATH = "avx512";
+#elif defined(__AVX2__)
+    template <>
+    struct lanes<int32_t> {
+        using reg = __m256i;
+        static constexpr int WIDTH = 8;
+        static reg load(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+        static void store(int32_t* p, reg v) { _mm256_storeu_si256((__m256i*)p, v); }
+        static reg splat(int32_t x) { return _mm256_set1_epi32(x); }
+        static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+        static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+        static reg max(reg a, reg b) { return _mm256_max_epi32(a, b); }
+        static reg keep_sentinel(reg x, reg value, reg sentinel) {
+            return _mm256_blendv_epi8(x, sentinel, _mm256_cmpeq_epi32(value, sentinel));
+        }
+        static __m256i select_changed(reg now, reg before, __m256i changed, __m256i kept) {
+            return _mm256_blendv_epi8(changed, kept, _mm256_cmpeq_epi32(now, before));
+        }
+    };
+
+    template <>
+    struct lanes<float> {
+        using reg = __m256;
+        static constexpr int WIDTH = 8;
+        static reg load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+        static reg splat(float x) { return _mm256_set1_ps(x); }
+        static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+        static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+        static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+        static __m256i select_changed(reg now, reg before, __m256i changed, __m256i kept) {
+            return _mm256_blendv_epi8(changed, kept, _mm256_castps_si256(_mm256_cmp_ps(now, before, _CMP_EQ_OQ)));
+        }
+    };
+
+    inline __m256i load_index(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    inline void store_index(int32_t* p, __m256i v) { _mm256_storeu_si256((__m256i*)p, v); }
+    constexpr const char* WEIGHT_SIMD_PATH = "avx2";
+#else
+    template <typename T>
+    struct lanes {
+        using reg = T;
+        static constexpr int WIDTH = 1;
+        static reg load(const T* p) { return *p; }
+        static void store(T* p, reg v) { *p = v; }
+        static reg splat(T x) { return x; }
+        static reg add(reg a, reg b) { return a + b; }
+        static reg min(reg a, reg b) { return b < a ? b : a; }
+        static reg max(reg a, reg b) { return a < b ? b : a; }
+        static reg keep_sentinel(reg x, reg value, reg sentinel) { return value == sentinel ? sentinel : x; }
+        static int32_t select_changed(reg now, reg before, int32_t changed, int32_t kept) {
+            return now != before ? changed : kept;
+        }
+    };
+
+    inline int32_t load_index(const int32_t* p) { return *p; }
+    inline void store_index(int32_t* p, int32_t v) { *p = v; }
+    constexpr const char* WEIGHT_SIMD_PATH = "scalar";
+#endif
+
+    // Row update shared by the weight semirings: row_i = plus(row_i, times(a, row_k)),
+    // and with predecessors, pred_i takes pred_k wherever row_i changed.
+    template <typename S>
+    inline void relax_weights(typename S::value_type* row_i, typename S::value_type a,
+        const typename S::value_type* row_k, int stride) {
+        using L = lanes<typename S::value_type>;
+        typename L::reg va = L::splat(a);
+        for (int j = 0; j < stride; j += L::WIDTH)
+            L::store(row_i + j, S::plus(L::load(row_i + j), S::times(va, L::load(row_k + j))));
+    }
+
+    template <typename S>
+    inline void relax_weights(typename S::value_type* row_i, int32_t* pred_i, typename S::value_type a,
+        const typename S::value_type* row_k, const int32_t* pred_k, int stride) {
+        using L = lanes<typename S::value_type>;
+        typename L::reg va = L::splat(a);
+        for (int j = 0; j < stride; j += L::WIDTH) {
+            typename L::reg before = L::load(row_i + j);
+            typename L::reg now = S::plus(before, S::times(va, L::load(row_k + j)));
+            L::store(row_i + j, now);
+            store_index(pred_i + j, L::select_changed(now, before, load_index(pred_k + j), load_index(pred_i + j)));
+        }
+    }
+
+    // (or, and) on bits. No path tracking: a bit row has no room for it.
+    struct Boolean {
+        using Matrix = bit_warshall::BitMatrix;
+        using value_type = bool;
+        static constexpr bool tracks_paths = false;
+
+        static bool has_path(const uint64_t* row_i, int k) { return (row_i[k / 64] >> (k % 64)) & 1; }
+        static bool at(const uint64_t*, int) { return true; }
+        static void relax(uint64_t* row_i, bool, const uint64_t* row_k, int stride) {
+            bit_warshall::or_row(row_i, row_k, stride);
+        }
+    };
+
+    // (min, +): shortest path lengths. zero() marks a missing edge; for int32
+    // it is INT32_MAX / 2 and times() keeps it, so a negative edge in front of
+    // a missing one stays missing. Negative cycles are not supported.
+    template <typename T>
+    struct MinPlus {
+        using Matrix = WeightMatrix<T>;
+        using value_type = T;
+        using L = lanes<T>;
+        static constexpr bool tracks_paths = true;
+
+        static T zero() {
+            if constexpr (std::is_floating_point<T>::value)
+                return std::numeric_limits<T>::infinity();
+            else
+                return std::numeric_limits<T>::max() / 2;
+        }
+        static T one() { return 0; }
+        static typename L::reg plus(typename L::reg a, typename L::reg b) { return L::min(a, b); }
+        static typename L::reg times(typename L::reg a, typename L::reg b) {
+            if constexpr (std::is_floating_point<T>::value)
+                return L::add(a, b);
+            else
+                return L::keep_sentinel(L::add(a, b), b, L::splat(zero()));
+        }
+
+        static bool has_path(const T* row_i, int k) { return row_i[k] != zero(); }
+        static T at(const T* row_i, int k) { return row_i[k]; }
+        static void relax(T* row_i, T a, const T* row_k, int stride) {
+            relax_weights<MinPlus>(row_i, a, row_k, stride);
+        }
+        static void relax(T* row_i, int32_t* pred_i, T a, const T* row_k, const int32_t* pred_k, int stride) {
+            relax_weights<MinPlus>(row_i, pred_i, a, row_k, pred_k, stride);
+        }
+    };
+
+    // (max, min): widest paths, the largest capacity of the narrowest edge.
+    // zero() (lowest value) marks a missing edge, one() is unlimited width.
+    template <typename T>
+    struct MaxMin {
+        using Matrix = WeightMatrix<T>;
+        using value_type = T;
+        using L = lanes<T>;
+        static constexpr bool tracks_paths = true;
+
+        static T zero() {
+            if constexpr (std::is_floating_point<T>::value)
+                return -std::numeric_limits<T>::infinity();
+            else
+                return std::numeric_limits<T>::lowest();
+        }
+        static T one() {
+            if constexpr (std::is_floating_point<T>::value)
+                return std::numeric_limits<T>::infinity();
+            else
+                return std::numeric_limits<T>::max();
+        }
+        static typename L::reg plus(typename L::reg a, typename L::reg b) { return L::max(a, b); }
+        static typename L::reg times(typename L::reg a, typename L::reg b) { return L::min(a, b); }
+
+        static bool has_path(const T* row_i, int k) { return row_i[k] != zero(); }
+        static T at(const T* row_i, int k) { return row_i[k]; }
+        static void relax(T* row_i, T a, const T* row_k, int stride) {
+            relax_weights<MaxMin>(row_i, a, row_k, stride);
+        }
+        static void relax(T* row_i, int32_t* pred_i, T a, const T* row_k, const int32_t* pred_k, int stride) {
+            relax_weights<MaxMin>(row_i, pred_i, a, row_k, pred_k, stride);
+        }
+    };
+
+    // Every entry zero() (no edge) except the diagonal, one() (the empty path).
+    template <typename S>
+    typename S::Matrix make_matrix(int n) {
+        typename S::Matrix matrix(n, S::zero());
+        for (int i = 0; i < n; i++)
+            matrix.at(i, i) = S::one();
+        return matrix;
+    }
+
+    // Warshall in place, rows in parallel for every k. Row k is not updated in
+    // round k (that would need a[k][k] below one(), a negative cycle), so all
+    // threads may read it while the other rows change.
+    template <typename S>
+    void closure(typename S::Matrix& matrix) {
+        int n = matrix.n;
+        int stride = matrix.stride;
+#pragma omp parallel
+        for (int k = 0; k < n; k++) {
+            const auto* row_k = matrix.row(k);
+#pragma omp for schedule(static)
+            for (int i = 0; i < n; i++) {
+                auto* row_i = matrix.row(i);
+                if (i != k && S::has_path(row_i, k))
+                    S::relax(row_i, S::at(row_i, k), row_k, stride);
+            }
+        }
+    }
+
+    // As above, also filling pred so that paths can be rebuilt with path().
+    template <typename S>
+    void closure(typename S::Matrix& matrix, Predecessors& pred) {
+        static_assert(S::tracks_paths, "this semiring cannot track predecessors");
+        int n = matrix.n;
+        int stride = matrix.stride;
+        pred = Predecessors(n, -1);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (i != j && S::has_path(matrix.row(i), j))
+                    pred.at(i, j) = i;
+            }
+        }
+#pragma omp parallel
+        for (int k = 0; k < n; k++) {
+            const auto* row_k = matrix.row(k);
+            const int32_t* pred_k = pred.row(k);
+#pragma omp for schedule(static)
+            for (int i = 0; i < n; i++) {
+                auto* row_i = matrix.row(i);
+                if (i != k && S::has_path(row_i, k))
+                    S::relax(row_i, pred.row(i), S::at(row_i, k), row_k, pred_k, stride);
+            }
+        }
+    }
+
+    // Vertices of the best path from -> to, both included; empty when there is
+    // none. A path from a vertex to itself is just that vertex.
+    std::vector<int> path(const Predecessors& pred, int from, int to);
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "warshall.h"
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace closure_trace {
+    std::atomic<bool> recording{ false };
+
+    static const char* const KIND_NAMES[KIND_COUNT] = { "k-step", "block-step", "diagonal", "panel", "tile", "wait" };
+
+    // Written only by its own thread while recording, read only after stop().
+    struct alignas(64) Ring {
+        std::vector<Span> spans;
+        uint64_t head = 0;
+    };
+
+    static std::vector<Ring> rings;
+    static std::chrono::steady_clock::time_point epoch;
+
+    void start(size_t spans_per_thread) {
+        recording.store(false);
+        rings = std::vector<Ring>(std::max(omp_get_max_threads(), omp_get_num_procs()));
+        for (Ring& ring : rings)
+            ring.spans.assign(std::max<size_t>(spans_per_thread, 1), Span());
+        epoch = std::chrono::steady_clock::now();
+        recording.store(true);
+    }
+
+    void stop() {
+        recording.store(false);
+    }
+
+    uint64_t now_ns() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(Kind kind, uint64_t start_ns, uint64_t end_ns, int arg) {
+        int thread = omp_get_thread_num();
+        if (thread >= (int)rings.size())
+            return;
+        Ring& ring = rings[thread];
+        Span& span = ring.spans[ring.head % ring.spans.size()];
+        span.start_ns = start_ns;
+        span.end_ns = end_ns;
+        span.arg = arg;
+        span.kind = kind;
+        ring.head++;
+    }
+
+    // Calls visit(span) for the spans still in the ring, oldest first.
+    template <typename Visit>
+    static void for_each_span(const Ring& ring, Visit visit) {
+        uint64_t capacity = ring.spans.size();
+        uint64_t first = ring.head > capacity ? ring.head - capacity : 0;
+        for (uint64_t s = first; s < ring.head; s++)
+            visit(ring.spans[s % capacity]);
+    }
+
+    std::vector<ThreadSummary> summarize() {
+        std::vector<ThreadSummary> summaries;
+        for (int t = 0; t < (int)rings.size(); t++) {
+            const Ring& ring = rings[t];
+            if (ring.head == 0)
+                continue;
+            ThreadSummary summary;
+            summary.thread = t;
+            summary.spans = (long long)ring.head;
+            summary.dropped = (long long)(ring.head > ring.spans.size() ? ring.head - ring.spans.size() : 0);
+            for_each_span(ring, [&](const Span& span) {
+                double ms = (span.end_ns - span.start_ns) / 1e6;
+                if (span.kind == WAIT)
+                    summary.wait_ms += ms;
+                else if (span.kind != BLOCK_STEP)
+                    summary.busy_ms += ms;
+            });
+            summaries.push_back(summary);
+        }
+        return summaries;
+    }
+
+    bool write_chrome_trace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+        bool first = true;
+        for (int t = 0; t < (int)rings.size(); t++) {
+            if (rings[t].head == 0)
+                continue;
+            out << (first ? "" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 0, \"tid\": " << t
+                << ", \"args\": {\"name\": \"omp thread " << t << "\"}}";
+            first = false;
+            for_each_span(rings[t], [&](const Span& span) {
+                out << ",\n{\"ph\": \"X\", \"cat\": \"closure\", \"name\": \"" << KIND_NAMES[span.kind]
+                    << "\", \"pid\": 0, \"tid\": " << t << ", \"ts\": " << span.start_ns / 1e3
+                    << ", \"dur\": " << (span.end_ns - span.start_ns) / 1e3
+                    << ", \"args\": {\"index\": " << span.arg << "}}";
+            });
+        }
+        out << "\n], \"otherData\": {\"threads\": [";
+        std::vector<ThreadSummary> summaries = summarize();
+        for (size_t s = 0; s < summaries.size(); s++) {
+            const ThreadSummary& summary = summaries[s];
+            out << (s ? ",\n" : "\n") << "  {\"thread\": " << summary.thread << ", \"spans\": " << summary.spans
+                << ", \"dropped\": " << summary.dropped << ", \"busy_ms\": " << summary.busy_ms
+                << ", \"wait_ms\": " << summary.wait_ms << "}";
+        }
+        out << "\n]}}\n";
+        return (bool)out;
+    }
+
+    //int main()
+    //{
+    //    // build the closure sources with -DCLOSURE_TRACE
+    //    bit_warshall::BitMatrix graph = bit_warshall::from_matrix(matrix, n);
+    //    start();
+    //    bit_warshall::transitive_closure_blocked(graph);
+    //    stop();
+    //    for (const ThreadSummary& summary : summarize())
+    //        std::cout << "thread " << summary.thread << ": busy " << summary.busy_ms << " ms, wait "
+    //            << summary.wait_ms << " ms" << std::endl;
+    //    write_chrome_trace("closure_trace.json");
+    //    return 0;
+    //}
+}
\ No newline at end of file